@@ -0,0 +1,128 @@
+// Loopback check of the busy-channel deferral: frames above and below
+// busy.threshold are sent to a ChannelMonitor's port, and waitForIdle() must
+// hold until idleTime after the loud traffic stops, or give up at maxDefer.
+//
+// Runs on a SimulatedClock: the traffic is sent from the clock's sleepUsec(),
+// one 20ms frame per wait, so the monitor sees it at the simulated time it
+// belongs to and a minute of deferral takes milliseconds.
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "timeannounce.h"
+
+// Advances simulated time and plays the channel's traffic for it: loud until
+// loudUntilUsec (after start), quiet frames after that
+class TrafficClock : public SimulatedClock {
+public:
+    TrafficClock(int port) : SimulatedClock(1700000000) {
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        memset(&dest, 0, sizeof(dest));
+        dest.sin_family = AF_INET;
+        dest.sin_port = htons(port);
+        dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    ~TrafficClock() { close(sock); }
+
+    void sleepUsec(long usec) override {
+        SimulatedClock::sleepUsec(usec);
+        if (!monitor) {
+            return;
+        }
+        long now = monotonicUsec();
+        bool loud = now - startUsec < loudUntilUsec;
+        send(loud ? 8000 : 100);
+        // Wait (in real time) for the monitor to stamp a loud frame at this
+        // simulated time, so it can't fall behind the waiting side
+        long deadline = ::monotonicUsec() + 1000000;
+        while (loud && monitor->lastActive() != now && ::monotonicUsec() < deadline) {
+            usleep(100);
+        }
+    }
+
+    ChannelMonitor* monitor = nullptr;
+    long startUsec = 0;
+    long loudUntilUsec = 0;
+
+private:
+    // One 20ms frame of a 440 Hz tone, in our length + PCM framing
+    void send(int amplitude) {
+        uint8_t packet[4 + FRAME_SIZE];
+        int16_t pcm[FRAME_SIZE / 2];
+        for (size_t i = 0; i < FRAME_SIZE / 2; i++) {
+            pcm[i] = static_cast<int16_t>(amplitude * sin(2 * M_PI * 440 * i / SAMPLE_RATE));
+        }
+        buildFrame(packet, reinterpret_cast<const uint8_t*>(pcm), FRAME_SIZE);
+        sendto(sock, packet, sizeof(packet), 0, (struct sockaddr*)&dest, sizeof(dest));
+    }
+
+    int sock;
+    struct sockaddr_in dest;
+};
+
+// A loopback port nothing is bound to
+int freePort() {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(sock, (struct sockaddr*)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (struct sockaddr*)&addr, &len);
+    close(sock);
+    return ntohs(addr.sin_port);
+}
+
+// How long (simulated ms) waitForIdle() held with loudMs of traffic, or -1
+long holdMs(long loudMs, int idleMs, float maxDefer) {
+    Config config;
+    config.busyEnabled = true;
+    config.busyBind = "127.0.0.1";
+    config.busyPort = freePort();
+    config.busyIdleTime = idleMs;
+    config.busyMaxDefer = maxDefer;
+
+    TrafficClock clock(config.busyPort);
+    ChannelMonitor monitor(config, clock);
+    if (!monitor.start()) {
+        return -1;
+    }
+    clock.monitor = &monitor;
+    clock.startUsec = clock.monotonicUsec();
+    clock.loudUntilUsec = loudMs * 1000L;
+    monitor.waitForIdle();
+    long held = (clock.monotonicUsec() - clock.startUsec) / 1000;
+    clock.monitor = nullptr;
+    monitor.stop();
+    return held;
+}
+
+bool check(const char* what, long held, long expectMs) {
+    // Loud frames are 20ms apart, so the last one lands up to a frame early
+    bool ok = held >= expectMs - 20 && held <= expectMs + 20;
+    std::cout << what << ": held " << held << " ms, expected " << expectMs << " ms: " << (ok ? "OK" : "FAIL")
+              << std::endl;
+    return ok;
+}
+
+int main() {
+    // A hang is a failure too
+    alarm(30);
+
+    long realStart = monotonicUsec();
+    bool ok = true;
+    // Quiet frames only: the channel still has to be observed idle first
+    ok = check("quiet channel", holdMs(0, 2000, 60), 2000) && ok;
+    // 3 s of traffic, then quiet: idleTime after the last loud frame
+    ok = check("traffic then quiet", holdMs(3000, 2000, 60), 5000) && ok;
+    // Traffic throughout: give up at maxDefer
+    ok = check("continuous traffic", holdMs(1000000, 2000, 10), 10000) && ok;
+    std::cout << "Real time " << (monotonicUsec() - realStart) / 1000 << " ms" << std::endl;
+    return ok ? 0 : 1;
+}
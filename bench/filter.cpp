@@ -0,0 +1,65 @@
+// Times the voice-band filter, with the settings from a config file, on a
+// minute of synthetic audio. Needs nothing beyond the library, unlike
+// bench-stages (whose BM_VoiceFilter covers the default settings).
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <time.h>
+
+#include "timeannounce.h"
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -c <file>   Config file whose filter settings to time (default: built-in defaults)" << std::endl;
+    std::cout << "  --help      Show this help" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    std::string configFile;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            configFile = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+    if (!configFile.empty()) {
+        config.load(configFile);
+    }
+
+    FilterSettings settings = config.filter;
+    settings.enabled = true;
+    if (settings.preEmphasis == 0) {
+        settings.preEmphasis = 6.0f;  // measure the full cascade
+    }
+
+    std::vector<int16_t> source(SAMPLE_RATE * 60);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < source.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        source[i] = static_cast<int16_t>(8000 * sin(2 * M_PI * 440 * i / SAMPLE_RATE)) +
+                    static_cast<int16_t>((seed >> 16) % 4000) - 2000;
+    }
+
+    const int runs = 20;
+    std::vector<int16_t> work;
+    struct timespec start, end;
+    double totalUsec = 0;
+    for (int r = 0; r < runs; r++) {
+        work = source;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        applyVoiceFilter(work, settings);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        totalUsec += (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+    }
+
+    double perSecond = totalUsec / runs / 60.0;
+    std::cout << "Voice filter (" << settings.signature() << "): " << perSecond
+              << " us per second of audio (" << 1e6 / perSecond << "x real time)" << std::endl;
+    return 0;
+}
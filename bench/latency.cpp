@@ -0,0 +1,272 @@
+// End-to-end latency benchmark: text -> generateTTSAudio -> paced UDP send,
+// received by an in-process sink on loopback.
+//
+// For each available engine it runs three cache states:
+//   cold   - empty segment cache, first synthesis by this engine in the run
+//   warm   - empty segment cache again, engine binary/model now in page cache
+//   cached - segment cache populated, no synthesis at all
+// and reports trigger-to-first-packet, trigger-to-first-voiced-sample,
+// synthesis realtime factor and peak RSS as JSON.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "timeannounce.h"
+
+struct Result {
+    std::string engine;
+    std::string state;
+    double synthesisMs = 0;
+    double firstPacketMs = -1;
+    double firstVoicedMs = -1;
+    double realtimeFactor = 0;
+    double audioSeconds = 0;
+    long peakRssKb = 0;
+    long peakChildRssKb = 0;
+};
+
+// Receives on loopback and notes when the first packet and the first packet
+// carrying a non-zero sample arrive
+class LoopbackSink {
+public:
+    bool start() {
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            perror("sink bind");
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(sock, (struct sockaddr*)&addr, &len);
+        port = ntohs(addr.sin_port);
+        running = true;
+        worker = std::thread(&LoopbackSink::run, this);
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        worker.join();
+        close(sock);
+    }
+
+    void reset() {
+        firstPacket = 0;
+        firstVoiced = 0;
+    }
+
+    int port = 0;
+    std::atomic<long> firstPacket{0};
+    std::atomic<long> firstVoiced{0};
+
+private:
+    void run() {
+        uint8_t buf[2048];
+        while (running) {
+            struct pollfd pfd = {sock, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            ssize_t n = recv(sock, buf, sizeof(buf), 0);
+            long now = monotonicUsec();
+            if (n <= 4) {
+                continue;
+            }
+            if (!firstPacket) {
+                firstPacket = now;
+            }
+            if (!firstVoiced) {
+                const int16_t* pcm = reinterpret_cast<const int16_t*>(buf + 4);
+                for (ssize_t i = 0; i < (n - 4) / 2; i++) {
+                    if (pcm[i] != 0) {
+                        firstVoiced = now;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    int sock = -1;
+    std::atomic<bool> running{false};
+    std::thread worker;
+};
+
+bool engineAvailable(const Config& config) {
+    if (system("command -v sox >/dev/null 2>&1") != 0) {
+        return false;
+    }
+    if (config.engine == "piper") {
+        return access(config.piperPath.c_str(), X_OK) == 0 && access(config.piperModel.c_str(), R_OK) == 0;
+    }
+    if (config.engine == "pico") {
+        return system("command -v pico2wave >/dev/null 2>&1") == 0;
+    }
+    return system("command -v espeak-ng >/dev/null 2>&1") == 0;
+}
+
+Result runOnce(const std::string& text, const Config& config, const std::string& state, LoopbackSink& sink) {
+    Result r;
+    r.engine = config.engine;
+    r.state = state;
+    sink.reset();
+
+    long trigger = monotonicUsec();
+    auto samples = generateTTSAudio(text, config, config.filter, *config.framing, false);
+    long generated = monotonicUsec();
+    SendOptions options;
+    options.prerollFrames = config.prerollFrames;
+    sendAudioToDVMBridge(samples, "127.0.0.1", sink.port, options);
+    usleep(50000);  // let the sink drain
+
+    r.synthesisMs = (generated - trigger) / 1000.0;
+    if (sink.firstPacket) r.firstPacketMs = (sink.firstPacket - trigger) / 1000.0;
+    if (sink.firstVoiced) r.firstVoicedMs = (sink.firstVoiced - trigger) / 1000.0;
+
+    // Realtime factor over the voiced span only, not the configured silence
+    size_t first = 0, last = samples.size();
+    while (first < samples.size() && samples[first] == 0) first++;
+    while (last > first && samples[last - 1] == 0) last--;
+    double voicedSeconds = (double)(last - first) / SAMPLE_RATE;
+    r.audioSeconds = (double)samples.size() / SAMPLE_RATE;
+    r.realtimeFactor = voicedSeconds > 0 ? (r.synthesisMs / 1000.0) / voicedSeconds : 0;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    r.peakRssKb = usage.ru_maxrss;
+    getrusage(RUSAGE_CHILDREN, &usage);
+    r.peakChildRssKb = usage.ru_maxrss;
+    return r;
+}
+
+// Both the on-disk segments and the clips the pipeline holds in memory
+void clearCache(const std::string& dir) {
+    clipStore().clear();
+    std::string cmd = "rm -f \"" + dir + "\"/*.raw";
+    if (system(cmd.c_str()) != 0) {
+        std::cerr << "Failed to clear " << dir << std::endl;
+    }
+}
+
+std::string toJson(const std::vector<Result>& results, const std::vector<std::string>& skipped) {
+    std::ostringstream out;
+    out << "{\n  \"timestamp\": " << time(nullptr) << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i ? "," : "") << "\n    {\"engine\": \"" << r.engine << "\", \"state\": \"" << r.state
+            << "\", \"synthesis_ms\": " << r.synthesisMs
+            << ", \"trigger_to_first_packet_ms\": " << r.firstPacketMs
+            << ", \"trigger_to_first_voiced_ms\": " << r.firstVoicedMs
+            << ", \"realtime_factor\": " << r.realtimeFactor
+            << ", \"audio_seconds\": " << r.audioSeconds
+            << ", \"peak_rss_kb\": " << r.peakRssKb
+            << ", \"peak_child_rss_kb\": " << r.peakChildRssKb << "}";
+    }
+    out << "\n  ],\n  \"skipped\": [";
+    for (size_t i = 0; i < skipped.size(); i++) {
+        out << (i ? ", " : "") << "\"" << skipped[i] << "\"";
+    }
+    out << "]\n}\n";
+    return out.str();
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -c <file>     Config file (default: config.yml)" << std::endl;
+    std::cout << "  -e <engines>  Comma-separated engines (default: espeak,pico,piper)" << std::endl;
+    std::cout << "  -t <text>     Announcement text (default: current time announcement)" << std::endl;
+    std::cout << "  -o <file>     Write JSON results to file (default: stdout)" << std::endl;
+    std::cout << "  --help        Show this help" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string configFile = "config.yml";
+    std::string engines = "espeak,pico,piper";
+    std::string text;
+    std::string outPath;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            configFile = argv[++i];
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            engines = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            text = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    Config base;
+    base.load(configFile);
+    base.settleTime = 0;
+    base.busyEnabled = false;
+    if (text.empty()) {
+        text = getTimeAnnouncement(base);
+    }
+
+    char cacheDir[] = "/tmp/ta-bench-XXXXXX";
+    if (!mkdtemp(cacheDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    base.cacheDir = cacheDir;
+
+    LoopbackSink sink;
+    if (!sink.start()) {
+        return 1;
+    }
+
+    std::vector<Result> results;
+    std::vector<std::string> skipped;
+    std::stringstream list(engines);
+    std::string engine;
+    while (std::getline(list, engine, ',')) {
+        Config config = base;
+        config.engine = engine;
+        if (!engineAvailable(config)) {
+            std::cerr << "Skipping " << engine << ": engine or sox not installed" << std::endl;
+            skipped.push_back(engine);
+            continue;
+        }
+
+        clearCache(cacheDir);
+        results.push_back(runOnce(text, config, "cold", sink));
+        clearCache(cacheDir);
+        results.push_back(runOnce(text, config, "warm", sink));
+        results.push_back(runOnce(text, config, "cached", sink));
+    }
+
+    sink.stop();
+    clearCache(cacheDir);
+    rmdir(cacheDir);
+
+    std::string json = toJson(results, skipped);
+    if (outPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(outPath) << json;
+        std::cerr << "Results written to " << outPath << std::endl;
+    }
+    return 0;
+}
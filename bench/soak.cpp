@@ -0,0 +1,315 @@
+// Scheduling soak on a simulated clock: runs the daemon's own announceOnce()
+// from the scheduler for a day (by default) of hourly announcements, pacing
+// every one of them through the real sender to a loopback socket, in well
+// under a second of real time.
+//
+// Checks that each announcement fires on its local-time boundary, speaks the
+// right hour, is rendered once, holds for the settle time and the busy-channel
+// idle window, takes exactly 20ms of (simulated) time per frame, arrives in
+// full, succeeds, and that the CW ID follows its interval.
+//
+// The speech is stood in for by a tone as long as the text would roughly take
+// to say, so no TTS engine is needed. One destination only: SimulatedClock
+// models a single paced activity, and the threaded sender would have one
+// sleeper per destination.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "timeannounce.h"
+
+// Counts the frames arriving on a loopback port
+class FrameCounter {
+public:
+    bool start() {
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            perror("counter bind");
+            return false;
+        }
+        // Simulated pacing sends as fast as the CPU allows
+        int size = 8 * 1024 * 1024;
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        socklen_t len = sizeof(addr);
+        getsockname(sock, (struct sockaddr*)&addr, &len);
+        port = ntohs(addr.sin_port);
+        running = true;
+        worker = std::thread(&FrameCounter::run, this);
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        worker.join();
+        close(sock);
+    }
+
+    // Wait (in real time) for `expected` frames, then reset the count
+    long collect(long expected) {
+        long deadline = monotonicUsec() + 2000000;
+        while (frames < expected && monotonicUsec() < deadline) {
+            usleep(1000);
+        }
+        return frames.exchange(0);
+    }
+
+    int port = 0;
+
+private:
+    void run() {
+        uint8_t buf[2048];
+        while (running) {
+            struct pollfd pfd = {sock, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            ssize_t n = recv(sock, buf, sizeof(buf), 0);
+            if (n == 4 + FRAME_SIZE) {
+                frames++;
+            }
+        }
+    }
+
+    int sock = -1;
+    std::atomic<bool> running{false};
+    std::atomic<long> frames{0};
+    std::thread worker;
+};
+
+// Lead silence, a tone standing in for the speech, optional ID, trail silence
+std::vector<int16_t> renderStandIn(const std::string& text, const Config& config, const FilterSettings& filter,
+                                   const FramingProfile& framing, bool withStationID) {
+    std::vector<int16_t> samples(static_cast<size_t>(config.leadSilence * SAMPLE_RATE), 0);
+    padToBoundary(samples, framing.unitSamples);
+
+    ToneSpec speech;
+    speech.freqs = {440.0f};
+    speech.duration = static_cast<int>(text.size() * 70);  // ~70ms per character spoken
+    renderTone(speech, samples);
+
+    if (withStationID) {
+        auto id = stationIDSegment(config, filter);
+        samples.insert(samples.end(), id->begin(), id->end());
+    }
+    samples.resize(samples.size() + static_cast<size_t>(config.trailSilence * SAMPLE_RATE), 0);
+    padToBoundary(samples, framing.unitSamples);
+    return samples;
+}
+
+// A loopback port nothing is bound to, for the busy-channel monitor
+int freePort() {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(sock, (struct sockaddr*)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (struct sockaddr*)&addr, &len);
+    close(sock);
+    return ntohs(addr.sin_port);
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -c <file>   Config file (default: built-in defaults)" << std::endl;
+    std::cout << "  -H <hours>  Simulated hours to run (default: 24)" << std::endl;
+    std::cout << "  -i <min>    Announcement interval in minutes (overrides config)" << std::endl;
+    std::cout << "  -v          Print every announcement" << std::endl;
+    std::cout << "  --help      Show this help" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    std::string configFile;
+    int hours = 24;
+    int interval = 0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            configFile = argv[++i];
+        } else if (strcmp(argv[i], "-H") == 0 && i + 1 < argc) {
+            hours = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    if (!configFile.empty()) {
+        config.load(configFile);
+    } else {
+        config.idEnabled = true;
+        config.idCallsign = "N0CALL";
+        config.idInterval = 120;
+    }
+    if (interval > 0) {
+        config.scheduleInterval = interval;
+    }
+
+    // Fresh ID state, so the first announcement always carries the ID
+    char statePath[] = "/tmp/soak-id-XXXXXX";
+    int stateFd = mkstemp(statePath);
+    if (stateFd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(stateFd);
+    unlink(statePath);
+    config.idStateFile = statePath;
+
+    FrameCounter counter;
+    if (!counter.start()) {
+        return 1;
+    }
+
+    // The first destination, aimed at the counter as plain PCM; the busy
+    // monitor listens on loopback, where nothing is sent, so it holds for
+    // exactly its idle window
+    Destination dest = config.destinations.empty()
+        ? Destination{"", 0, config.filter, config.framing, "", WireFormat()}
+        : config.destinations.front();
+    dest.host = "127.0.0.1";
+    dest.port = counter.port;
+    dest.shm = "";
+    dest.wire = WireFormat();
+    config.destinations = {dest};
+    config.sendBackend = "threads";
+    config.busyEnabled = true;
+    config.busyBind = "127.0.0.1";
+    config.busyPort = freePort();
+    std::vector<std::unique_ptr<Transport>> transports = openTransports(config);
+    long holdUsec = std::max(static_cast<long>(config.settleTime * 1000000), config.busyIdleTime * 1000L);
+
+    // Stands in for generateTTSAudio, noting what announceOnce asked for
+    int renders = 0;
+    std::string rendered;
+    bool renderedID = false;
+    long renderedFrames = 0;
+    AnnouncementRenderer render = [&](const std::string& text, const Config& config, const FilterSettings& filter,
+                                      const FramingProfile& framing, bool withStationID) {
+        renders++;
+        rendered = text;
+        renderedID = withStationID;
+        auto samples = renderStandIn(text, config, filter, framing, withStationID);
+        renderedFrames = (samples.size() * sizeof(int16_t) + FRAME_SIZE - 1) / FRAME_SIZE;
+        return samples;
+    };
+
+    // Start at 00:07 local time on a fixed date, so the first slot needs aligning
+    struct tm start;
+    memset(&start, 0, sizeof(start));
+    start.tm_year = 2026 - 1900;
+    start.tm_mon = 0;
+    start.tm_mday = 1;
+    start.tm_min = 7;
+    start.tm_isdst = -1;
+    time_t begin = mktime(&start);
+    SimulatedClock clock(begin);
+
+    int failures = 0;
+    int ids = 0;
+    long totalFrames = 0;
+    long realStart = monotonicUsec();
+
+    auto fail = [&](time_t slot, const std::string& what) {
+        char when[32];
+        struct tm local;
+        localtime_r(&slot, &local);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M", &local);
+        std::cerr << "FAIL " << when << ": " << what << std::endl;
+        failures++;
+    };
+
+    int count = runScheduler(clock, config.scheduleInterval, [&](time_t slot) {
+        struct tm local;
+        localtime_r(&slot, &local);
+        if ((local.tm_hour * 60 + local.tm_min) % config.scheduleInterval != 0 || local.tm_sec != 0) {
+            fail(slot, "slot not on an interval boundary");
+        }
+        time_t now = clock.now();
+        if (now < slot || now - slot > 1) {
+            fail(slot, "fired " + std::to_string(now - slot) + " s from its slot");
+        }
+
+        int rendersBefore = renders;
+        long announceStart = clock.monotonicUsec();
+        int status = announceOnce(config, "", false, clock, transports, render);
+        long took = clock.monotonicUsec() - announceStart;
+        if (status != 0) {
+            fail(slot, "announceOnce returned " + std::to_string(status));
+        }
+        if (renders - rendersBefore != 1) {
+            fail(slot, "rendered " + std::to_string(renders - rendersBefore) + " times");
+        }
+
+        int hour12 = local.tm_hour % 12 == 0 ? 12 : local.tm_hour % 12;
+        std::string expect = config.use12Hour ? " " + std::to_string(hour12) + " o'clock" : "";
+        if (rendered.find(expect) == std::string::npos) {
+            fail(slot, "announced \"" + rendered + "\"");
+        }
+        ids += renderedID;
+
+        long frames = renderedFrames;
+        if (took != holdUsec + frames * 20000L) {
+            fail(slot, "announcement took " + std::to_string(took) + " us for " + std::to_string(frames) +
+                       " frames after a " + std::to_string(holdUsec) + " us hold");
+        }
+        long received = counter.collect(frames);
+        if (received != frames) {
+            fail(slot, "received " + std::to_string(received) + " of " + std::to_string(frames) + " frames");
+        }
+        totalFrames += frames;
+
+        if (verbose) {
+            std::cout << rendered << (renderedID ? " (+ID)" : "") << ", " << frames << " frames" << std::endl;
+        }
+        return true;
+    }, begin + hours * 3600L);
+
+    counter.stop();
+    unlink(statePath);
+
+    long expected = hours * 60L / config.scheduleInterval;
+    if (count != expected) {
+        std::cerr << "FAIL: " << count << " announcements, expected " << expected << std::endl;
+        failures++;
+    }
+    // An ID every `period` announcements, allowing for stationIDDue's minute of slack
+    long expectedIDs = 0;
+    if (config.idEnabled && !config.idCallsign.empty()) {
+        long period = std::max(1L, (config.idInterval - 1L + config.scheduleInterval - 1) / config.scheduleInterval);
+        expectedIDs = (expected + period - 1) / period;
+    }
+    if (ids != expectedIDs) {
+        std::cerr << "FAIL: " << ids << " station IDs, expected " << expectedIDs << std::endl;
+        failures++;
+    }
+
+    printf("%d announcements (%d with ID), %ld frames over %d simulated hours in %.2f s real time: %s\n",
+           count, ids, totalFrames, hours, (monotonicUsec() - realStart) / 1e6,
+           failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+// Microbenchmarks for the individual audio pipeline stages, at realistic
+// announcement sizes from 1 second to 10 minutes of 8kHz audio. Throughput is
+// reported as items/s, where an item is one sample.
+//
+// Resampling isn't covered: conversion to 8kHz is done by sox, out of process.
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <benchmark/benchmark.h>
+
+#include "timeannounce.h"
+
+namespace {
+
+// Speech-like test signal: a few seconds of tone bursts with noise, separated
+// by pauses, so the trimmer, gate and limiter all have something to do
+std::vector<int16_t> testSignal(size_t seconds) {
+    std::vector<int16_t> samples(seconds * SAMPLE_RATE);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < samples.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        bool voiced = (i / (SAMPLE_RATE / 4)) % 4 != 3;
+        double v = voiced ? 9000 * sin(2 * M_PI * 180 * i / SAMPLE_RATE) +
+                            4000 * sin(2 * M_PI * 1250 * i / SAMPLE_RATE) : 0;
+        samples[i] = static_cast<int16_t>(v + (int)((seed >> 16) % 600) - 300);
+    }
+    return samples;
+}
+
+void audioSizes(benchmark::internal::Benchmark* b) {
+    for (int seconds : {1, 10, 60, 600}) {
+        b->Arg(seconds);
+    }
+    b->Unit(benchmark::kMicrosecond);
+}
+
+void BM_Ingest(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    std::vector<int16_t> samples;
+    for (auto _ : state) {
+        FILE* f = fmemopen(source.data(), source.size() * sizeof(int16_t), "rb");
+        samples.clear();
+        readSamples(f, samples);
+        fclose(f);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_Ingest)->Apply(audioSizes);
+
+void BM_SilenceGeneration(benchmark::State& state) {
+    size_t n = state.range(0) * SAMPLE_RATE;
+    for (auto _ : state) {
+        std::vector<int16_t> samples;
+        samples.resize(n, 0);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SilenceGeneration)->Apply(audioSizes);
+
+void BM_LDUPadding(benchmark::State& state) {
+    // Worst case: one sample past a boundary, on a buffer without spare capacity
+    auto source = testSignal(state.range(0));
+    source.resize(source.size() / 1440 * 1440 + 1);
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<int16_t> samples(source);
+        samples.shrink_to_fit();
+        state.ResumeTiming();
+        padToBoundary(samples, 1440);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_LDUPadding)->Apply(audioSizes);
+
+void BM_Packetisation(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(source.data());
+    size_t totalBytes = source.size() * sizeof(int16_t);
+    uint8_t packet[4 + FRAME_SIZE];
+    for (auto _ : state) {
+        for (size_t offset = 0; offset < totalBytes; offset += FRAME_SIZE) {
+            buildFrame(packet, data + offset, std::min((size_t)FRAME_SIZE, totalBytes - offset));
+            benchmark::DoNotOptimize(packet);
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_Packetisation)->Apply(audioSizes);
+
+void BM_ULawPacketisation(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(source.data());
+    size_t frames = source.size() * sizeof(int16_t) / FRAME_SIZE;
+    WireFormat format;
+    format.encoding = WIRE_ULAW;
+    FrameEncoder encoder(format);
+    uint8_t packet[MAX_DATAGRAM];
+    for (auto _ : state) {
+        for (size_t i = 0; i < frames; i++) {
+            benchmark::DoNotOptimize(encoder.encode(data + i * FRAME_SIZE, packet));
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * frames * FRAME_SIZE / sizeof(int16_t));
+}
+BENCHMARK(BM_ULawPacketisation)->Apply(audioSizes);
+
+void BM_Trim(benchmark::State& state) {
+    // Long silent lead-in and tail, the case trimming exists for
+    auto speech = testSignal(state.range(0));
+    std::vector<int16_t> source(SAMPLE_RATE / 2, 0);
+    source.insert(source.end(), speech.begin(), speech.end());
+    source.resize(source.size() + SAMPLE_RATE / 2, 0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<int16_t> samples(source);
+        state.ResumeTiming();
+        trimSilence(samples, -50.0f, 60);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_Trim)->Apply(audioSizes);
+
+void BM_FrameEnergy(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    for (auto _ : state) {
+        int64_t total = 0;
+        for (size_t start = 0; start + 160 <= source.size(); start += 160) {
+            total += blockEnergy(source.data() + start, 160);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_FrameEnergy)->Apply(audioSizes);
+
+void BM_TimeCompress(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    for (auto _ : state) {
+        auto out = timeCompress(source, 1.25);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_TimeCompress)->Apply(audioSizes);
+
+void BM_GainAndLimiter(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<int16_t> samples(source);
+        state.ResumeTiming();
+        normalizeLoudness(samples, -12.0f, -1.0f, 5.0f);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_GainAndLimiter)->Apply(audioSizes);
+
+void BM_VoiceFilter(benchmark::State& state) {
+    auto source = testSignal(state.range(0));
+    FilterSettings settings;
+    settings.enabled = true;
+    settings.preEmphasis = 6.0f;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<int16_t> samples(source);
+        state.ResumeTiming();
+        applyVoiceFilter(samples, settings);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_VoiceFilter)->Apply(audioSizes);
+
+void BM_Chime(benchmark::State& state) {
+    ToneSpec tone;
+    tone.freqs = {880.0f, 1320.0f};
+    tone.duration = state.range(0) * 1000;
+    std::vector<ToneSpec> chime = {tone};
+    for (auto _ : state) {
+        auto samples = generateChime(chime);
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * SAMPLE_RATE);
+}
+BENCHMARK(BM_Chime)->Apply(audioSizes);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    // The pipeline logs each step to stdout; keep that out of the report
+    std::ofstream devNull("/dev/null");
+    std::streambuf* stdoutBuf = std::cout.rdbuf(devNull.rdbuf());
+    std::ostream report(stdoutBuf);
+
+    benchmark::ConsoleReporter reporter;
+    reporter.SetOutputStream(&report);
+    reporter.SetErrorStream(&std::cerr);
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+
+    std::cout.rdbuf(stdoutBuf);
+    return 0;
+}
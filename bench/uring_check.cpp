@@ -0,0 +1,135 @@
+// Loopback check of the io_uring sender's failure handling: one destination
+// with a listener and one with nothing listening, at several queue depths.
+// The dead one must abort on ECONNREFUSED without holding up the live one,
+// and sendAudioUring() must return once the live one has finished.
+//
+// Exits 0 (with a note) when io_uring isn't available here, since the caller
+// would fall back to the threaded sender anyway.
+
+#include <iostream>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "timeannounce.h"
+
+// A loopback UDP port, optionally counting what arrives on it
+class Listener {
+public:
+    bool start(bool counting) {
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            perror("listener bind");
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(sock, (struct sockaddr*)&addr, &len);
+        port = ntohs(addr.sin_port);
+        if (!counting) {
+            // Free the port again, so sends to it are refused
+            close(sock);
+            sock = -1;
+            return true;
+        }
+        running = true;
+        worker = std::thread(&Listener::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (running) {
+            running = false;
+            worker.join();
+        }
+        if (sock >= 0) {
+            close(sock);
+        }
+    }
+
+    int port = 0;
+    std::atomic<long> frames{0};
+
+private:
+    void run() {
+        uint8_t buf[2048];
+        while (running) {
+            struct pollfd pfd = {sock, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            if (recv(sock, buf, sizeof(buf), 0) == 4 + FRAME_SIZE) {
+                frames++;
+            }
+        }
+    }
+
+    int sock = -1;
+    std::atomic<bool> running{false};
+    std::thread worker;
+};
+
+// 1 if the check passed, 0 if not, -1 if io_uring isn't usable at all
+int checkBatch(int batch, int preroll) {
+    Listener live, dead;
+    if (!live.start(true) || !dead.start(false)) {
+        return 0;
+    }
+
+    std::vector<int16_t> samples(SAMPLE_RATE / 2, 1000);  // 25 frames
+    long frames = samples.size() * sizeof(int16_t) / FRAME_SIZE;
+    UdpTransport liveTransport("127.0.0.1", live.port);
+    UdpTransport deadTransport("127.0.0.1", dead.port);
+    std::vector<Transmission> transmissions(2);
+    transmissions[0].transport = &liveTransport;
+    transmissions[1].transport = &deadTransport;
+    for (auto& t : transmissions) {
+        t.samples = &samples;
+        t.options.prerollFrames = preroll;
+    }
+
+    long startUsec = monotonicUsec();
+    bool viaUring = sendAudioUring(transmissions, batch);
+    long tookMs = (monotonicUsec() - startUsec) / 1000;
+    usleep(100000);
+    live.stop();
+    dead.stop();
+    if (!viaUring) {
+        return -1;
+    }
+
+    // The live stream's frames take 20ms each; a stuck wait would run on
+    // to the settle deadline or beyond
+    long expectMs = (frames - preroll) * 20;
+    bool ok = transmissions[0].ok && !transmissions[1].ok && live.frames == frames && tookMs < expectMs + 500;
+    std::cout << "batch " << batch << ", pre-roll " << preroll << ": live " << live.frames << "/" << frames
+              << " frames, dead " << (transmissions[1].ok ? "NOT aborted" : "aborted") << ", " << tookMs
+              << " ms: " << (ok ? "OK" : "FAIL") << std::endl;
+    return ok;
+}
+
+int main() {
+    // A hang is a failure too
+    alarm(30);
+
+    bool ok = true;
+    for (int batch : {1, 2, 8}) {
+        for (int preroll : {0, 5}) {
+            int result = checkBatch(batch, preroll);
+            if (result < 0) {
+                std::cout << "io_uring not available, nothing to check" << std::endl;
+                return 0;
+            }
+            ok = ok && result;
+        }
+    }
+    return ok ? 0 : 1;
+}
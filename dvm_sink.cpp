@@ -0,0 +1,575 @@
+// dvm-sink: a stand-in for DVMBridge's UDP audio input.
+//
+// Receives what time-announce sends (4-byte big-endian length + 320 bytes of
+// 8kHz 16-bit PCM per 20ms frame), validates the framing, measures the pacing
+// of each transmission and optionally saves the audio as a WAV file. With
+// --shm it is instead the consumer end of the shared-memory transport.
+
+#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+
+#include "framing.h"
+#include "g711.h"
+#include "shm_ring.h"
+
+constexpr int FRAME_SIZE = 320;
+constexpr int SAMPLE_RATE = 8000;
+constexpr long FRAME_USEC = 20000;
+
+// Payload encodings: behind the length header, pcm unless -e says otherwise;
+// in RTP packets, whatever the payload type says
+enum Encoding { PCM, ULAW, ALAW, L16 };
+
+struct Transmission {
+    std::vector<int16_t> samples;
+    std::vector<long> arrivals;  // usec, kernel receive timestamps (shm: publish times)
+    int badHeader = 0;           // length field or RTP header doesn't match the datagram
+    int badSize = 0;             // well-formed, but not 20ms of audio
+    long wireBytes = 0;          // Datagram bytes, headers included
+    std::string format;          // Wire format of the last frame
+    bool rtp = false;
+    uint16_t sequence = 0;       // Last RTP sequence number
+    int sequenceErrors = 0;      // RTP packets lost or out of order
+};
+
+long timespecUsec(const struct timespec& ts) {
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+bool writeWav(const std::string& path, const std::vector<int16_t>& samples) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        perror(path.c_str());
+        return false;
+    }
+
+    uint32_t dataBytes = samples.size() * sizeof(int16_t);
+    uint32_t riffSize = 36 + dataBytes;
+    uint32_t fmtSize = 16, rate = SAMPLE_RATE, byteRate = SAMPLE_RATE * 2;
+    uint16_t format = 1, channels = 1, blockAlign = 2, bits = 16;
+
+    fwrite("RIFF", 1, 4, f);
+    fwrite(&riffSize, 4, 1, f);
+    fwrite("WAVEfmt ", 1, 8, f);
+    fwrite(&fmtSize, 4, 1, f);
+    fwrite(&format, 2, 1, f);
+    fwrite(&channels, 2, 1, f);
+    fwrite(&rate, 4, 1, f);
+    fwrite(&byteRate, 4, 1, f);
+    fwrite(&blockAlign, 2, 1, f);
+    fwrite(&bits, 2, 1, f);
+    fwrite("data", 1, 4, f);
+    fwrite(&dataBytes, 4, 1, f);
+    fwrite(samples.data(), sizeof(int16_t), samples.size(), f);
+    fclose(f);
+    return true;
+}
+
+void report(const Transmission& tx, int index, const FramingProfile& framing) {
+    size_t frames = tx.arrivals.size();
+    std::cout << "Transmission " << index << ": " << frames << " frames ("
+              << (float)tx.samples.size() / SAMPLE_RATE << " seconds of audio)" << std::endl;
+    if (tx.badHeader || tx.badSize) {
+        std::cout << "  FRAMING ERRORS: " << tx.badHeader << " bad headers, "
+                  << tx.badSize << " frames not " << FRAME_SIZE / 2 << " samples" << std::endl;
+    }
+    if (frames > 0) {
+        // Payload and RTP/length header, plus the UDP and IPv4 headers on top
+        double perFrame = (double)tx.wireBytes / frames;
+        printf("  Wire: %s, %.0f bytes per datagram, %.1f kbit/s with UDP/IPv4 headers\n",
+               tx.format.c_str(), perFrame, (perFrame + 28) * 8 * 1000000 / FRAME_USEC / 1000);
+    }
+    if (tx.sequenceErrors) {
+        std::cout << "  RTP sequence errors: " << tx.sequenceErrors << std::endl;
+    }
+
+    size_t remainder = tx.samples.size() % framing.unitSamples;
+    std::cout << "  " << framing.name << " alignment: " << (remainder == 0 ? "OK" : "NOT ALIGNED")
+              << " (" << tx.samples.size() / framing.unitSamples << " " << framing.unit << "s";
+    if (remainder) {
+        std::cout << " + " << remainder << " samples";
+    }
+    std::cout << ")" << std::endl;
+
+    // First frame with anything other than digital silence
+    for (size_t i = 0; i < tx.samples.size(); i++) {
+        if (tx.samples[i] != 0) {
+            size_t frame = std::min(i / (FRAME_SIZE / 2), frames - 1);
+            std::cout << "  First non-silent sample at " << i * 1000 / SAMPLE_RATE << " ms of audio, arrived "
+                      << (tx.arrivals[frame] - tx.arrivals[0]) / 1000 << " ms after the first frame" << std::endl;
+            break;
+        }
+    }
+
+    if (frames < 2) {
+        return;
+    }
+
+    // A sender pre-roll delivers the first frames back to back; pacing is
+    // measured from the last of them
+    size_t first = 0;
+    while (first + 1 < frames && tx.arrivals[first + 1] - tx.arrivals[first] < FRAME_USEC / 4) {
+        first++;
+    }
+    if (first > 0) {
+        printf("  Opening burst: %zu frames in %.3f ms (pre-roll)\n", first + 1,
+               (tx.arrivals[first] - tx.arrivals[0]) / 1000.0);
+    }
+    if (frames - first < 2) {
+        return;
+    }
+
+    // Inter-arrival statistics, plus an RFC 3550 style smoothed jitter estimate
+    double sum = 0, sumSq = 0, jitter = 0;
+    long minGap = tx.arrivals[first + 1] - tx.arrivals[first], maxGap = minGap;
+    int late = 0;
+    for (size_t i = first + 1; i < frames; i++) {
+        long gap = tx.arrivals[i] - tx.arrivals[i - 1];
+        sum += gap;
+        sumSq += (double)gap * gap;
+        minGap = std::min(minGap, gap);
+        maxGap = std::max(maxGap, gap);
+        jitter += (std::abs(gap - FRAME_USEC) - jitter) / 16.0;
+        if (gap > FRAME_USEC * 3 / 2) {
+            late++;
+        }
+    }
+    size_t gaps = frames - 1 - first;
+    double mean = sum / gaps;
+    double stddev = sqrt(std::max(0.0, sumSq / gaps - mean * mean));
+    long elapsed = tx.arrivals.back() - tx.arrivals[first];
+    long drift = elapsed - (long)gaps * FRAME_USEC;
+
+    printf("  Inter-arrival: mean %.3f ms, stddev %.3f ms, min %.3f ms, max %.3f ms\n",
+           mean / 1000, stddev / 1000, minGap / 1000.0, maxGap / 1000.0);
+    printf("  Jitter (RFC 3550): %.3f ms, gaps > 30 ms: %d\n", jitter / 1000, late);
+    printf("  Elapsed %.3f s, pacing drift %+.3f ms vs real time\n", elapsed / 1e6, drift / 1000.0);
+
+    // Frame period by least squares, which averages the jitter out. Longer
+    // than 20ms means this host's clock runs fast relative to the sender's.
+    // Run it on the bridge host, over a long transmission, to measure the
+    // correction the sender needs.
+    double n = frames - first, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = first; i < frames; i++) {
+        double x = i - first, y = tx.arrivals[i] - tx.arrivals[first];
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double period = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double ppm = (period / FRAME_USEC - 1) * 1e6;
+    printf("  Frame period %.4f ms (%+.1f ppm): add that to the sender's pacing.driftPpm\n",
+           period / 1000, ppm);
+}
+
+// Append one datagram to the transmission: the 4-byte length header over
+// audio in the given encoding, or an RTP packet (version 2, so its first
+// byte can't be the top of a length)
+void addFrame(Transmission& tx, const uint8_t* packet, ssize_t n, long arrivalUsec, Encoding encoding) {
+    const uint8_t* payload;
+    size_t bytes;
+    if (n >= 12 && (packet[0] >> 6) == 2) {
+        size_t header = 12 + 4 * (packet[0] & 0x0F);
+        if ((packet[0] & 0x10) && n >= (ssize_t)header + 4) {
+            header += 4 + 4 * ((packet[header + 2] << 8) | packet[header + 3]);
+        }
+        size_t padding = (packet[0] & 0x20) ? packet[n - 1] : 0;
+        if (header + padding > static_cast<size_t>(n)) {
+            tx.badHeader++;
+            return;
+        }
+        int payloadType = packet[1] & 0x7F;
+        encoding = payloadType == 0 ? ULAW : payloadType == 8 ? ALAW : L16;
+        tx.format = payloadType == 0 ? "RTP PCMU" : payloadType == 8 ? "RTP PCMA"
+                                      : "RTP L16 (payload type " + std::to_string(payloadType) + ")";
+        uint16_t sequence = (packet[2] << 8) | packet[3];
+        if (tx.rtp && sequence != static_cast<uint16_t>(tx.sequence + 1)) {
+            tx.sequenceErrors++;
+        }
+        tx.rtp = true;
+        tx.sequence = sequence;
+        payload = packet + header;
+        bytes = n - header - padding;
+    } else {
+        if (n < 4) {
+            tx.badHeader++;
+            return;
+        }
+        uint32_t len = (uint32_t(packet[0]) << 24) | (uint32_t(packet[1]) << 16) |
+                       (uint32_t(packet[2]) << 8) | uint32_t(packet[3]);
+        if (len != static_cast<size_t>(n - 4)) {
+            tx.badHeader++;
+            return;
+        }
+        tx.format = encoding == ULAW ? "ulaw" : encoding == ALAW ? "alaw" : "pcm";
+        payload = packet + 4;
+        bytes = len;
+    }
+
+    size_t count = (encoding == ULAW || encoding == ALAW) ? bytes : bytes / sizeof(int16_t);
+    if (count != FRAME_SIZE / 2) {
+        tx.badSize++;
+    }
+    tx.arrivals.push_back(arrivalUsec);
+    tx.wireBytes += n;
+    size_t base = tx.samples.size();
+    tx.samples.resize(base + count);
+    int16_t* out = tx.samples.data() + base;
+    if (encoding == ULAW) {
+        decodeULaw(payload, out, count);
+    } else if (encoding == ALAW) {
+        decodeALaw(payload, out, count);
+    } else if (encoding == L16) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = static_cast<int16_t>((payload[2 * i] << 8) | payload[2 * i + 1]);
+        }
+    } else {
+        memcpy(out, payload, count * sizeof(int16_t));
+    }
+}
+
+// Report a finished transmission, save it if asked, and start the next
+void endTransmission(Transmission& tx, int index, const FramingProfile& framing, const std::string& wavPath) {
+    report(tx, index, framing);
+    if (!wavPath.empty()) {
+        std::string path = wavPath;
+        if (index > 1) {
+            size_t dot = path.rfind('.');
+            std::string suffix = "-" + std::to_string(index);
+            path = (dot == std::string::npos) ? path + suffix : path.insert(dot, suffix);
+        }
+        if (writeWav(path, tx.samples)) {
+            std::cout << "  Saved audio to " << path << std::endl;
+        }
+    }
+    tx = Transmission();
+}
+
+// Consumer end of the shared-memory transport: accept a sender on a unix
+// socket, map the ring it hands over and drain it, sleeping on the eventfd
+// doorbell whenever the ring is empty
+int runShm(const std::string& path, int endGapMs, const FramingProfile& framing, Encoding encoding,
+           const std::string& wavPath, bool once) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    unlink(path.c_str());
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 1) < 0) {
+        perror(path.c_str());
+        return 1;
+    }
+    std::cout << "Listening on shm:" << path << std::endl;
+
+    Transmission tx;
+    int index = 0;
+    bool done = false;
+    while (!done) {
+        int conn = accept(listener, nullptr, nullptr);
+        if (conn < 0) {
+            perror("accept");
+            break;
+        }
+
+        // The sender's first and only message: the ring's memfd and the doorbell
+        uint32_t magic = 0;
+        struct iovec iov = {&magic, sizeof(magic)};
+        char cmsgBuf[CMSG_SPACE(2 * sizeof(int))];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cmsgBuf;
+        msg.msg_controllen = sizeof(cmsgBuf);
+        int fds[2] = {-1, -1};
+        ssize_t n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+        struct cmsghdr* cmsg = n > 0 ? CMSG_FIRSTHDR(&msg) : nullptr;
+        if (cmsg && cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len == CMSG_LEN(sizeof(fds))) {
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+        }
+        ShmRing* ring = nullptr;
+        if (n == sizeof(magic) && magic == SHM_RING_MAGIC && fds[0] >= 0) {
+            void* mapped = mmap(nullptr, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+            ring = mapped == MAP_FAILED ? nullptr : static_cast<ShmRing*>(mapped);
+        }
+        if (fds[0] >= 0) {
+            close(fds[0]);
+        }
+        if (!ring || ring->version != SHM_RING_VERSION || ring->slots != SHM_RING_SLOTS ||
+            ring->slotBytes != SHM_SLOT_BYTES) {
+            std::cerr << "Rejected a sender: not a compatible ring" << std::endl;
+            if (ring) {
+                munmap(ring, sizeof(ShmRing));
+            }
+            if (fds[1] >= 0) {
+                close(fds[1]);
+            }
+            close(conn);
+            continue;
+        }
+        int doorbell = fds[1];
+        std::cout << "Sender connected" << std::endl;
+
+        bool connected = true;
+        while (true) {
+            uint64_t head = ring->head.load(std::memory_order_relaxed);
+            if (head != ring->tail.load(std::memory_order_acquire)) {
+                const ShmSlot& slot = ring->ring[head % SHM_RING_SLOTS];
+                addFrame(tx, slot.data, std::min(slot.bytes, SHM_SLOT_BYTES), slot.usec, encoding);
+                ring->head.store(head + 1, std::memory_order_release);
+                continue;
+            }
+            if (!connected) {
+                break;
+            }
+
+            // Say we're going to sleep, then look once more: a frame published
+            // in between either shows up here or rings the doorbell
+            ring->consumerWaiting.store(1, std::memory_order_seq_cst);
+            if (ring->tail.load(std::memory_order_seq_cst) != head) {
+                ring->consumerWaiting.store(0, std::memory_order_relaxed);
+                continue;
+            }
+            struct pollfd pfds[2] = {{doorbell, POLLIN, 0}, {conn, POLLIN, 0}};
+            int ready = poll(pfds, 2, tx.arrivals.empty() ? -1 : endGapMs);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("poll");
+                connected = false;
+                continue;
+            }
+            if (ready == 0) {
+                // Quiet for endGapMs: the transmission is over
+                endTransmission(tx, ++index, framing, wavPath);
+                if (once) {
+                    done = true;
+                    break;
+                }
+                continue;
+            }
+            if (pfds[0].revents & POLLIN) {
+                uint64_t count;
+                if (read(doorbell, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                    perror("eventfd");
+                }
+            }
+            if (pfds[1].revents) {
+                // The sender never writes after the handshake, so this is it going away
+                std::cout << "Sender disconnected" << std::endl;
+                connected = false;
+            }
+        }
+        if (!done && !tx.arrivals.empty()) {
+            endTransmission(tx, ++index, framing, wavPath);
+            done = once;
+        }
+
+        munmap(ring, sizeof(ShmRing));
+        close(doorbell);
+        close(conn);
+    }
+
+    close(listener);
+    unlink(path.c_str());
+    return 0;
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -b <addr>   Address to bind (default: 0.0.0.0)" << std::endl;
+    std::cout << "  -p <port>   UDP port to listen on (default: 32001)" << std::endl;
+    std::cout << "  -w <file>   Write each transmission to a WAV file (file, file-2, ...)" << std::endl;
+    std::cout << "  -g <ms>     Silence that ends a transmission (default: 1000)" << std::endl;
+    std::cout << "  -f <name>   Framing to check alignment against: p25, dmr, nxdn, none (default: p25)" << std::endl;
+    std::cout << "  -e <name>   Encoding behind the length header: pcm, ulaw, alaw (default: pcm;" << std::endl;
+    std::cout << "              RTP packets are recognised and decoded by payload type)" << std::endl;
+    std::cout << "  -m <group>  Join an IPv4 multicast group and take its frames on the port;" << std::endl;
+    std::cout << "              several sinks on one host may join the same group" << std::endl;
+    std::cout << "  -i <iface>  Interface to join the group on, by name or address (default: routing table)" << std::endl;
+    std::cout << "  --shm <path> Take frames from a shared-memory sender on this unix socket, not UDP" << std::endl;
+    std::cout << "  -1          Exit after the first transmission" << std::endl;
+    std::cout << "  --help      Show this help" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string bindAddr = "0.0.0.0";
+    int port = 32001;
+    std::string wavPath;
+    int endGapMs = 1000;
+    const FramingProfile* framing = findFramingProfile("p25");
+    bool once = false;
+    std::string shmPath;
+    std::string group;
+    std::string interface;
+    Encoding encoding = PCM;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            bindAddr = argv[++i];
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            wavPath = argv[++i];
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            endGapMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            framing = findFramingProfile(argv[++i]);
+            if (!framing) {
+                std::cerr << "Unknown framing " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "ulaw") {
+                encoding = ULAW;
+            } else if (name == "alaw") {
+                encoding = ALAW;
+            } else if (name != "pcm") {
+                std::cerr << "Unknown encoding " << name << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            group = argv[++i];
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interface = argv[++i];
+        } else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shmPath = argv[++i];
+        } else if (strcmp(argv[i], "-1") == 0) {
+            once = true;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    if (!shmPath.empty()) {
+        return runShm(shmPath, endGapMs, *framing, encoding, wavPath, once);
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_aton(bindAddr.c_str(), &addr.sin_addr);
+
+    // Bound to the group itself, so each sink sees only the group's frames,
+    // and sharing the port with any other sink that joined it
+    struct ip_mreqn mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    if (!group.empty()) {
+        if (inet_aton(group.c_str(), &mreq.imr_multiaddr) == 0 || !IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr))) {
+            std::cerr << "Not an IPv4 multicast group: " << group << std::endl;
+            return 1;
+        }
+        if (!interface.empty() && inet_aton(interface.c_str(), &mreq.imr_address) == 0) {
+            mreq.imr_ifindex = if_nametoindex(interface.c_str());
+            if (mreq.imr_ifindex == 0) {
+                perror(("interface " + interface).c_str());
+                return 1;
+            }
+        }
+        addr.sin_addr = mreq.imr_multiaddr;
+        bindAddr = group;
+        int reuse = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    if (!group.empty() && setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        perror("IP_ADD_MEMBERSHIP");
+        return 1;
+    }
+
+    // Kernel receive timestamps, so our own scheduling doesn't show up as jitter
+    int on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+
+    std::cout << "Listening on " << bindAddr << ":" << port << std::endl;
+
+    Transmission tx;
+    int index = 0;
+    uint8_t packet[2048];
+    char control[256];
+
+    while (true) {
+        struct pollfd pfd = {sock, POLLIN, 0};
+        int ready = poll(&pfd, 1, tx.arrivals.empty() ? -1 : endGapMs);
+        if (ready < 0) {
+            perror("poll");
+            break;
+        }
+        if (ready == 0) {
+            // Quiet for endGapMs: the transmission is over
+            endTransmission(tx, ++index, *framing, wavPath);
+            if (once) {
+                break;
+            }
+            continue;
+        }
+
+        struct iovec iov = {packet, sizeof(packet)};
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t n = recvmsg(sock, &msg, 0);
+        if (n < 0) {
+            perror("recvmsg");
+            continue;
+        }
+
+        struct timespec arrival;
+        clock_gettime(CLOCK_REALTIME, &arrival);
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                memcpy(&arrival, CMSG_DATA(c), sizeof(arrival));
+            }
+        }
+
+        addFrame(tx, packet, n, timespecUsec(arrival), encoding);
+    }
+
+    close(sock);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#!/bin/bash
+# Build the release, LTO and PGO configurations and run the stage benchmarks
+# on each, writing JSON results to build/bench-<config>.json and printing a
+# throughput table (Msamples/s) in the format of docs/BENCHMARKS.md.
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+cmake --preset release && cmake --build --preset release -j"$(nproc)"
+cmake --preset lto && cmake --build --preset lto -j"$(nproc)"
+scripts/pgo-build.sh
+
+for config in release lto pgo; do
+    build/$config/bench-stages --benchmark_min_time=0.5 --benchmark_repetitions=3 \
+        --benchmark_report_aggregates_only=true \
+        --benchmark_out=build/bench-$config.json --benchmark_out_format=json
+done
+
+python3 - <<'PY'
+import json
+
+results = {}
+for config in ("release", "lto", "pgo"):
+    with open(f"build/bench-{config}.json") as f:
+        for b in json.load(f)["benchmarks"]:
+            if b.get("aggregate_name") == "median":
+                name = b["run_name"]
+                results.setdefault(name, {})[config] = b["items_per_second"] / 1e6
+
+print("| Stage | Release | LTO | PGO |")
+print("|---|---:|---:|---:|")
+for name, row in results.items():
+    print(f"| {name} | " + " | ".join(f"{row.get(c, 0):.1f}" for c in ("release", "lto", "pgo")) + " |")
+PY
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <map>
+#include <thread>
+
+#include "announce.h"
+#include "capture.h"
+#include "channel_monitor.h"
+#include "pacing_stats.h"
+#include "pcap.h"
+#include "pipeline.h"
+#include "uring_sender.h"
+
+std::vector<std::unique_ptr<Transport>> openTransports(const Config& config) {
+    MulticastSettings multicast;
+    multicast.ttl = config.multicastTtl;
+    multicast.interface = config.multicastInterface;
+    multicast.loop = config.multicastLoop;
+    std::vector<std::unique_ptr<Transport>> transports;
+    for (const auto& dest : config.destinations) {
+        if (!dest.shm.empty()) {
+            transports.emplace_back(new ShmTransport(dest.shm));
+        } else {
+            transports.emplace_back(new UdpTransport(dest.host, dest.port, config.resolveInterval, multicast));
+        }
+    }
+    return transports;
+}
+
+std::string renderKey(const Destination& dest) {
+    return dest.filter.signature() + "|framing=" + dest.framing->name;
+}
+
+int announceOnce(const Config& config, const std::string& customText, bool testMode, Clock& clock,
+                 std::vector<std::unique_ptr<Transport>>& transports, const AnnouncementRenderer& render) {
+    // Get announcement text
+    std::string announcement = customText.empty() ? getTimeAnnouncement(config, clock) : customText;
+    std::cout << "Announcement: " << announcement << std::endl;
+
+    // Start watching the channel now, so generation time counts towards the idle window
+    ChannelMonitor monitor(config, clock);
+    if (config.busyEnabled && !testMode) {
+        monitor.start();
+    }
+    
+    time_t now = clock.now();
+    bool withStationID = stationIDDue(config, now);
+    
+    // Render once per distinct filter and framing; destinations sharing both share the audio
+    std::map<std::string, std::vector<int16_t>> rendered;
+    for (const auto& dest : config.destinations) {
+        std::string key = renderKey(dest);
+        if (rendered.count(key)) {
+            continue;
+        }
+        auto samples = render(announcement, config, dest.filter, *dest.framing, withStationID);
+        if (samples.empty()) {
+            std::cerr << "No audio generated" << std::endl;
+            return 1;
+        }
+        rendered[key] = std::move(samples);
+    }
+
+    if (testMode) {
+        std::cout << "Test mode - not sending to DVMBridge" << std::endl;
+        for (const auto& entry : rendered) {
+            std::cout << "Audio duration (" << entry.first << "): "
+                      << (float)entry.second.size() / SAMPLE_RATE << " seconds" << std::endl;
+        }
+        return 0;
+    }
+
+    // Give system time to settle after TTS generation (especially for neural TTS like piper)
+    if (config.settleTime > 0) {
+        std::cout << "Waiting " << config.settleTime << " seconds for system to settle..." << std::endl;
+        clock.sleepUsec(static_cast<long>(config.settleTime * 1000000));
+    }
+    
+    // Don't talk over traffic already on the talkgroup
+    monitor.waitForIdle();
+    monitor.stop();
+
+    // Optional recording of each destination's frames/datagrams as sent
+    std::vector<std::unique_ptr<AudioCapture>> captures(config.destinations.size());
+    std::vector<std::unique_ptr<PacketCapture>> pcaps(config.destinations.size());
+    std::vector<PacingStats> stats(config.txTimestamps ? config.destinations.size() : 0);
+    for (size_t i = 0; i < config.destinations.size(); i++) {
+        std::string suffix = config.destinations.size() > 1 ? "-dest" + std::to_string(i + 1) : "";
+        if (config.captureEnabled) {
+            captures[i].reset(new AudioCapture(config, suffix));
+            if (!captures[i]->start(now)) {
+                captures[i].reset();
+            }
+        }
+        if (config.capturePcap && config.destinations[i].shm.empty()) {
+            pcaps[i].reset(new PacketCapture(config, suffix));
+            if (!pcaps[i]->start(now)) {
+                pcaps[i].reset();
+            }
+        }
+    }
+
+    // All destinations transmit at the same time
+    std::vector<Transmission> transmissions(config.destinations.size());
+    for (size_t i = 0; i < config.destinations.size(); i++) {
+        Transmission& t = transmissions[i];
+        t.samples = &rendered[renderKey(config.destinations[i])];
+        t.transport = transports[i].get();
+        t.options.clock = &clock;
+        t.options.capture = captures[i].get();
+        t.options.pcap = pcaps[i].get();
+        t.options.stats = stats.empty() ? nullptr : &stats[i];
+        t.options.hardwareTimestamps = config.hardwareTimestamps;
+        t.options.driftPpm = config.driftPpm;
+        t.options.prerollFrames = config.prerollFrames;
+        t.options.wire = config.destinations[i].wire;
+    }
+    
+    // One thread pacing them all through io_uring, or one thread each
+    bool viaUring = config.sendBackend == "uring" && sendAudioUring(transmissions, config.uringBatch);
+    if (config.sendBackend == "uring" && !viaUring) {
+        std::cerr << "Sending on a thread per destination instead" << std::endl;
+    }
+    if (!viaUring) {
+        std::vector<std::thread> senders;
+        for (auto& t : transmissions) {
+            Transmission* transmission = &t;
+            senders.emplace_back([transmission]() {
+                transmission->ok = sendAudioToDVMBridge(*transmission->samples, *transmission->transport,
+                                                        transmission->options);
+            });
+        }
+        for (auto& sender : senders) {
+            sender.join();
+        }
+    }
+    for (size_t i = 0; i < stats.size(); i++) {
+        stats[i].report(transports[i]->name());
+    }
+    captures.clear();
+    pcaps.clear();
+    
+    // The ID only counts as sent if it went out somewhere
+    bool anySent = false;
+    bool allSent = true;
+    for (const auto& t : transmissions) {
+        anySent = anySent || t.ok;
+        allSent = allSent && t.ok;
+    }
+    if (withStationID && anySent) {
+        recordStationID(config, now);
+    }
+    return allSent ? 0 : 1;
+}
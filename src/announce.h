@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "clock.h"
+#include "config.h"
+#include "framing.h"
+#include "pipeline.h"
+#include "transport.h"
+
+// Produces one destination's audio for an announcement; generateTTSAudio
+// unless a caller (the soak, say) wants to skip the TTS engine
+using AnnouncementRenderer = std::function<std::vector<int16_t>(
+    const std::string& text, const Config& config, const FilterSettings& filter,
+    const FramingProfile& framing, bool withStationID)>;
+
+// A transport per destination, in config.destinations order: shared memory
+// where shm is set, otherwise UDP (multicast settings applied to groups)
+std::vector<std::unique_ptr<Transport>> openTransports(const Config& config);
+
+// Destinations with the same key get the same rendered audio
+std::string renderKey(const Destination& dest);
+
+// Generate and transmit one announcement: render once per distinct filter and
+// framing, settle, wait out channel traffic, then send to every destination at
+// once (recording the CW ID as sent if any of them got it). Returns the
+// process exit status: 0 only if every destination received the lot.
+int announceOnce(const Config& config, const std::string& customText, bool testMode, Clock& clock,
+                 std::vector<std::unique_ptr<Transport>>& transports,
+                 const AnnouncementRenderer& render = generateTTSAudio);
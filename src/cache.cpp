@@ -0,0 +1,193 @@
+#include <iostream>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "cache.h"
+
+// Name of the file holding a cached segment: 64-bit FNV-1a of its key
+std::string segmentCachePath(const Config& config, const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.raw", (unsigned long long)hash);
+    return config.cacheDir + "/" + name;
+}
+
+bool loadCachedSegment(const Config& config, const std::string& key, std::vector<int16_t>& samples) {
+    if (config.cacheDir.empty()) {
+        return false;
+    }
+
+    std::string path = segmentCachePath(config, key);
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long bytes = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    // Empty or truncated mid-sample: not something we wrote, render it again
+    if (bytes <= 0 || bytes % sizeof(int16_t) != 0) {
+        fclose(f);
+        return false;
+    }
+    samples.resize(bytes / sizeof(int16_t));
+    size_t got = fread(samples.data(), sizeof(int16_t), samples.size(), f);
+    fclose(f);
+    if (got != samples.size()) {
+        samples.clear();
+        return false;
+    }
+
+    std::cout << "Using cached segment " << path << " (" << samples.size() << " samples)" << std::endl;
+    return true;
+}
+
+void storeCachedSegment(const Config& config, const std::string& key, const std::vector<int16_t>& samples) {
+    if (config.cacheDir.empty()) {
+        return;
+    }
+
+    // Write to a temp name and rename, so a concurrent run never reads half a file
+    std::string path = segmentCachePath(config, key);
+    std::string tmpPath = path + "." + std::to_string(getpid());
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) {
+        std::cerr << "Failed to write cache file " << tmpPath << std::endl;
+        return;
+    }
+    bool ok = fwrite(samples.data(), sizeof(int16_t), samples.size(), f) == samples.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write cache file " << path << std::endl;
+        unlink(tmpPath.c_str());
+    }
+}
+
+// Directory and file name, for matching inotify events on the directory
+static void splitPath(const std::string& path, std::string& dir, std::string& name) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        dir = ".";
+        name = path;
+    } else {
+        dir = slash == 0 ? "/" : path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+ClipStore::~ClipStore() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+ClipStore::Clip ClipStore::find(const std::string& key, const std::string& source) {
+    std::lock_guard<std::mutex> guard(lock);
+    drainLocked();
+    auto it = clips.find(key);
+    if (it == clips.end() || clipSources[key] != source) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void ClipStore::store(const std::string& key, Clip clip, const std::string& source) {
+    std::lock_guard<std::mutex> guard(lock);
+    clips[key] = std::move(clip);
+    clipSources[key] = source;
+}
+
+void ClipStore::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    clips.clear();
+    clipSources.clear();
+}
+
+bool ClipStore::watching(const std::string& source) {
+    std::lock_guard<std::mutex> guard(lock);
+    return watchLocked(source);
+}
+
+bool ClipStore::watchLocked(const std::string& source) {
+    std::string dir, name;
+    splitPath(source, dir, name);
+    for (const auto& watch : dirs) {
+        if (watch.second == dir) {
+            return true;
+        }
+    }
+
+    if (fd < 0) {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+    }
+    int wd = inotify_add_watch(fd, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                               IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    if (wd < 0) {
+        return false;
+    }
+    dirs[wd] = dir;
+    return true;
+}
+
+// Drop every clip whose source has changed since the last call
+void ClipStore::drainLocked() {
+    if (fd < 0) {
+        return;
+    }
+
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + n; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            auto watch = dirs.find(event->wd);
+            // Overflowed queue: anything may have changed
+            bool all = event->mask & IN_Q_OVERFLOW;
+            bool wholeDir = event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED);
+            if (!all && watch == dirs.end()) {
+                continue;
+            }
+
+            std::string reported;
+            for (auto it = clips.begin(); it != clips.end();) {
+                const std::string& source = clipSources[it->first];
+                std::string dir, name;
+                splitPath(source, dir, name);
+                bool changed = !source.empty() &&
+                               (all || (dir == watch->second && (wholeDir || (event->len && name == event->name))));
+                if (changed) {
+                    if (reported != source) {
+                        std::cout << source << " changed, reloading it for the next announcement" << std::endl;
+                        reported = source;
+                    }
+                    clipSources.erase(it->first);
+                    it = clips.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            // The directory itself went away; watch it again when next asked
+            if (!all && wholeDir) {
+                if (!(event->mask & IN_IGNORED)) {
+                    inotify_rm_watch(fd, event->wd);
+                }
+                dirs.erase(watch);
+            }
+        }
+    }
+}
+
+ClipStore& clipStore() {
+    static ClipStore store;
+    return store;
+}
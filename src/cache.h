@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+std::string segmentCachePath(const Config& config, const std::string& key);
+bool loadCachedSegment(const Config& config, const std::string& key, std::vector<int16_t>& samples);
+void storeCachedSegment(const Config& config, const std::string& key, const std::vector<int16_t>& samples);
+
+// Processed clips held in memory for the life of the process and shared by
+// reference, so a daemon's announcements don't read them back from cacheDir.
+// A clip made from a file is dropped when that file changes: an inotify watch
+// on its directory (to see it replaced by rename as well as rewritten), which
+// find() drains with a non-blocking read rather than a stat. Thread-safe.
+class ClipStore {
+public:
+    using Clip = std::shared_ptr<const std::vector<int16_t>>;
+
+    ~ClipStore();
+
+    // source is the file the clip was made from, or empty for a generated
+    // one. Returns nullptr when not held, or if source has changed since.
+    Clip find(const std::string& key, const std::string& source = "");
+    void store(const std::string& key, Clip clip, const std::string& source = "");
+
+    // Forget every clip, so the next announcement renders them afresh
+    void clear();
+
+    // Whether changes to source are being watched; when not, callers should
+    // put its size and mtime in the key instead
+    bool watching(const std::string& source);
+
+private:
+    bool watchLocked(const std::string& source);
+    void drainLocked();
+
+    std::mutex lock;
+    std::map<std::string, Clip> clips;
+    std::map<std::string, std::string> clipSources;  // Key -> file it was made from
+    int fd = -1;
+    std::map<int, std::string> dirs;  // Watch descriptor -> directory
+};
+
+ClipStore& clipStore();
@@ -0,0 +1,199 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "capture.h"
+
+static void writeWavHeader(FILE* f, uint32_t dataBytes) {
+    uint32_t riffSize = 36 + dataBytes;
+    uint32_t fmtSize = 16, rate = SAMPLE_RATE, byteRate = SAMPLE_RATE * 2;
+    uint16_t format = 1, channels = 1, blockAlign = 2, bits = 16;
+
+    fwrite("RIFF", 1, 4, f);
+    fwrite(&riffSize, 4, 1, f);
+    fwrite("WAVEfmt ", 1, 8, f);
+    fwrite(&fmtSize, 4, 1, f);
+    fwrite(&format, 2, 1, f);
+    fwrite(&channels, 2, 1, f);
+    fwrite(&rate, 4, 1, f);
+    fwrite(&byteRate, 4, 1, f);
+    fwrite(&blockAlign, 2, 1, f);
+    fwrite(&bits, 2, 1, f);
+    fwrite("data", 1, 4, f);
+    fwrite(&dataBytes, 4, 1, f);
+}
+
+std::string captureBasePath(const Config& config, time_t when, const std::string& suffix) {
+    struct tm local;
+    localtime_r(&when, &local);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    return config.captureDir + "/time-announce-" + stamp + suffix;
+}
+
+void pruneCaptures(const Config& config) {
+    if (config.captureMaxFiles <= 0) {
+        return;
+    }
+    DIR* dir = opendir(config.captureDir.c_str());
+    if (!dir) {
+        return;
+    }
+
+    // One recording is everything written for one announcement: all the
+    // -destN streams and -partN rotations share its time-announce-<date>-<time>
+    // prefix. Note the newest modification time and the files of each.
+    const size_t prefixLength = strlen("time-announce-YYYYmmdd-HHMMSS");
+    std::map<std::string, time_t> captures;
+    std::map<std::string, std::vector<std::string>> files;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        size_t dot = name.rfind('.');
+        if (name.compare(0, 14, "time-announce-") != 0 || dot == std::string::npos || dot < prefixLength) {
+            continue;
+        }
+        std::string ext = name.substr(dot);
+        if (ext != ".wav" && ext != ".csv" && ext != ".pcap") {
+            continue;
+        }
+        struct stat st;
+        std::string path = config.captureDir + "/" + name;
+        if (stat(path.c_str(), &st) == 0) {
+            std::string recording = name.substr(0, prefixLength);
+            captures[recording] = std::max(captures[recording], st.st_mtime);
+            files[recording].push_back(path);
+        }
+    }
+    closedir(dir);
+
+    if (captures.size() <= static_cast<size_t>(config.captureMaxFiles)) {
+        return;
+    }
+    std::vector<std::pair<time_t, std::string>> byAge;
+    for (const auto& entry : captures) {
+        byAge.emplace_back(entry.second, entry.first);
+    }
+    std::sort(byAge.begin(), byAge.end());
+    for (size_t i = 0; i < byAge.size() - config.captureMaxFiles; i++) {
+        for (const auto& path : files[byAge[i].second]) {
+            unlink(path.c_str());
+        }
+    }
+}
+
+AudioCapture::~AudioCapture() {
+    stop();
+}
+
+bool AudioCapture::start(time_t when) {
+    basePath = captureBasePath(config, when, suffix);
+    if (!openPart()) {
+        return false;
+    }
+
+    running = true;
+    worker = std::thread(&AudioCapture::run, this);
+    return true;
+}
+
+void AudioCapture::stop() {
+    if (running) {
+        // The writer drains whatever is still in the ring before exiting
+        running = false;
+        worker.join();
+        closePart();
+        if (droppedFrames) {
+            std::cerr << "Warning: capture dropped " << droppedFrames << " frames" << std::endl;
+        }
+    }
+}
+
+bool AudioCapture::push(const uint8_t* pcm, size_t bytes, long usec) {
+    if (!running) {
+        return false;
+    }
+    Slot* slot = ring.claim();
+    if (!slot) {
+        droppedFrames++;
+        return false;
+    }
+    slot->usec = usec;
+    slot->bytes = static_cast<uint16_t>(std::min(bytes, sizeof(slot->pcm)));
+    memcpy(slot->pcm, pcm, slot->bytes);
+    ring.publish();
+    return true;
+}
+
+void AudioCapture::run() {
+    while (true) {
+        bool stopping = !running;
+        Slot* slot = ring.front();
+        if (!slot) {
+            if (stopping) {
+                break;
+            }
+            usleep(5000);
+            continue;
+        }
+        write(*slot);
+        ring.pop();
+    }
+}
+
+void AudioCapture::write(const Slot& slot) {
+    if (config.captureMaxSize > 0 && dataBytes + slot.bytes > config.captureMaxSize * 1024L * 1024L) {
+        closePart();
+        openPart();
+    }
+    if (!wav) {
+        return;
+    }
+
+    if (firstUsec < 0) {
+        firstUsec = slot.usec;
+    }
+    fwrite(slot.pcm, 1, slot.bytes, wav);
+    dataBytes += slot.bytes;
+    fprintf(csv, "%ld,%ld,%u\n", frameIndex++, slot.usec - firstUsec, slot.bytes);
+}
+
+bool AudioCapture::openPart() {
+    part++;
+    std::string path = basePath + (part > 1 ? "-part" + std::to_string(part) : "");
+    wav = fopen((path + ".wav").c_str(), "wb");
+    if (!wav) {
+        perror((path + ".wav").c_str());
+        return false;
+    }
+    csv = fopen((path + ".csv").c_str(), "w");
+    if (!csv) {
+        perror((path + ".csv").c_str());
+        fclose(wav);
+        wav = nullptr;
+        return false;
+    }
+
+    // Sizes are filled in when the part is closed
+    dataBytes = 0;
+    writeWavHeader(wav, 0);
+    fprintf(csv, "frame,usec,bytes\n");
+    std::cout << "Capturing transmitted audio to " << path << ".wav" << std::endl;
+    pruneCaptures(config);
+    return true;
+}
+
+void AudioCapture::closePart() {
+    if (!wav) {
+        return;
+    }
+    fseek(wav, 0, SEEK_SET);
+    writeWavHeader(wav, dataBytes);
+    fclose(wav);
+    fclose(csv);
+    wav = nullptr;
+    csv = nullptr;
+}
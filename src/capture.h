@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "spsc_ring.h"
+
+// <captureDir>/time-announce-<date>-<time><suffix>, without an extension
+std::string captureBasePath(const Config& config, time_t when, const std::string& suffix);
+
+// Delete the oldest recordings beyond captureMaxFiles, where a recording is
+// everything (all destinations and parts) sharing one announcement's timestamp
+void pruneCaptures(const Config& config);
+
+// Records the frames a sender transmits, exactly as sent, to a WAV file plus a
+// CSV of per-frame send times. The pacing loop only copies each frame into a
+// lock-free single-producer ring; a background thread does all the file I/O.
+// If the writer falls behind, frames are dropped from the capture (and
+// counted) rather than ever holding up the transmission.
+//
+// Files are named captureBasePath() + .wav/.csv, split into parts of at most
+// captureMaxSize MB, and the oldest recordings are deleted to keep at most
+// captureMaxFiles.
+class AudioCapture {
+public:
+    AudioCapture(const Config& config, const std::string& suffix) : config(config), suffix(suffix) {}
+    ~AudioCapture();
+
+    bool start(time_t when);
+    void stop();
+
+    // Called from the pacing loop, never blocks. usec is the send time.
+    bool push(const uint8_t* pcm, size_t bytes, long usec);
+
+    long dropped() const { return droppedFrames; }
+
+private:
+    static constexpr size_t RING_SLOTS = 256;  // ~5 seconds of frames
+
+    struct Slot {
+        long usec;
+        uint16_t bytes;
+        uint8_t pcm[FRAME_SIZE];
+    };
+
+    void run();
+    void write(const Slot& slot);
+    bool openPart();
+    void closePart();
+
+    const Config& config;
+    std::string suffix;
+    std::string basePath;
+
+    SpscRing<Slot, RING_SLOTS> ring;
+    std::atomic<long> droppedFrames{0};
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    // Writer thread only
+    FILE* wav = nullptr;
+    FILE* csv = nullptr;
+    int part = 0;
+    long frameIndex = 0;
+    long firstUsec = -1;
+    uint32_t dataBytes = 0;
+};
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "channel_monitor.h"
+#include "dsp.h"
+#include "sender.h"
+
+ChannelMonitor::~ChannelMonitor() {
+    stop();
+}
+
+bool ChannelMonitor::start() {
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return false;
+    }
+    int on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.busyPort);
+    inet_aton(config.busyBind.c_str(), &addr.sin_addr);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind (busy monitor)");
+        close(sock);
+        sock = -1;
+        return false;
+    }
+    
+    // Nothing heard yet: the channel has to be observed quiet for idleTime first
+    startUsec = clock.monotonicUsec();
+    lastActiveUsec = startUsec;
+    running = true;
+    worker = std::thread(&ChannelMonitor::run, this);
+    std::cout << "Monitoring channel activity on " << config.busyBind << ":" << config.busyPort << std::endl;
+    return true;
+}
+
+void ChannelMonitor::stop() {
+    if (running) {
+        running = false;
+        worker.join();
+    }
+    if (sock >= 0) {
+        close(sock);
+        sock = -1;
+    }
+}
+
+void ChannelMonitor::waitForIdle() {
+    if (sock < 0) {
+        return;
+    }
+    const long idleUsec = config.busyIdleTime * 1000L;
+    const long maxUsec = static_cast<long>(config.busyMaxDefer * 1000000);
+    bool announced = false;
+    
+    while (true) {
+        long now = clock.monotonicUsec();
+        long quiet = now - lastActiveUsec;
+        if (quiet >= idleUsec) {
+            break;
+        }
+        if (now - startUsec >= maxUsec) {
+            std::cerr << "Warning: channel still busy after " << config.busyMaxDefer
+                      << " seconds, transmitting anyway" << std::endl;
+            break;
+        }
+        if (!announced && lastActiveUsec > startUsec) {
+            std::cout << "Channel busy, holding announcement..." << std::endl;
+            announced = true;
+        }
+        clock.sleepUsec(std::min(idleUsec - quiet, 20000L));
+    }
+    if (announced) {
+        std::cout << "Channel idle after " << (clock.monotonicUsec() - startUsec) / 1000 << " ms" << std::endl;
+    }
+}
+
+void ChannelMonitor::run() {
+    const size_t frameLen = SAMPLE_RATE / 50;
+    double level = pow(10.0, config.busyThreshold / 20.0) * 32768.0;
+    const double threshold = level * level * frameLen;
+    uint8_t buf[4096];
+    int16_t pcm[2048];
+    
+    while (running) {
+        struct pollfd pfd = {sock, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        ssize_t n = recv(sock, buf, sizeof(buf), 0);
+        if (n < 4) {
+            continue;
+        }
+        uint32_t len = (uint32_t(buf[0]) << 24) | (uint32_t(buf[1]) << 16) |
+                       (uint32_t(buf[2]) << 8) | uint32_t(buf[3]);
+        if (len > static_cast<size_t>(n - 4)) {
+            continue;  // Not a frame we understand
+        }
+        size_t count = len / sizeof(int16_t);
+        memcpy(pcm, buf + 4, count * sizeof(int16_t));
+        for (size_t start = 0; start < count; start += frameLen) {
+            size_t frame = std::min(frameLen, count - start);
+            if ((double)blockEnergy(pcm + start, frame) >= threshold * frame / frameLen) {
+                lastActiveUsec = clock.monotonicUsec();
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "clock.h"
+#include "config.h"
+
+// Listens for the audio DVMBridge receives from the talkgroup (sent to us in the
+// same 4-byte length + PCM framing we transmit with) and tracks when a 20ms
+// frame was last above the traffic threshold. Started before TTS generation so
+// the observation window overlaps it instead of adding to it. Times and waits
+// go through clock, so a simulated run doesn't really sit out the hold-off.
+class ChannelMonitor {
+public:
+    explicit ChannelMonitor(const Config& config, Clock& clock = systemClock()) : config(config), clock(clock) {}
+    ~ChannelMonitor();
+    
+    bool start();
+    void stop();
+    
+    // Block until the channel has been quiet for idleTime, or maxDefer has passed
+    void waitForIdle();
+    
+    // Clock time of the last frame above the threshold (start() if none yet)
+    long lastActive() const { return lastActiveUsec; }
+    
+private:
+    void run();
+    
+    const Config& config;
+    Clock& clock;
+    int sock = -1;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<long> lastActiveUsec{0};
+    long startUsec = 0;
+};
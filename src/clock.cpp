@@ -0,0 +1,56 @@
+#include <cerrno>
+#include <time.h>
+
+#include "clock.h"
+
+long SystemClock::monotonicUsec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+time_t SystemClock::now() {
+    return time(nullptr);
+}
+
+void SystemClock::sleepUsec(long usec) {
+    if (usec <= 0) {
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = usec / 1000000L;
+    ts.tv_nsec = (usec % 1000000L) * 1000L;
+    // Resume after signals rather than cutting the wait short
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+}
+
+long SimulatedClock::monotonicUsec() {
+    std::lock_guard<std::mutex> guard(lock);
+    return elapsedUsec;
+}
+
+time_t SimulatedClock::now() {
+    std::lock_guard<std::mutex> guard(lock);
+    return wallStart + elapsedUsec / 1000000L;
+}
+
+void SimulatedClock::sleepUsec(long usec) {
+    if (usec > 0) {
+        advanceUsec(usec);
+    }
+}
+
+void SimulatedClock::advanceUsec(long usec) {
+    std::lock_guard<std::mutex> guard(lock);
+    elapsedUsec += usec;
+}
+
+Clock& systemClock() {
+    static SystemClock clock;
+    return clock;
+}
+
+long monotonicUsec() {
+    return systemClock().monotonicUsec();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ctime>
+#include <mutex>
+
+// Time source for pacing and scheduling. Everything that waits or reads the
+// time goes through one of these, so tests and soak runs can substitute a
+// simulated clock and cover hours of operation in seconds.
+class Clock {
+public:
+    virtual ~Clock() {}
+    
+    virtual long monotonicUsec() = 0;    // For measuring intervals
+    virtual time_t now() = 0;            // Wall-clock time
+    virtual void sleepUsec(long usec) = 0;
+};
+
+// The real clocks: CLOCK_MONOTONIC, time() and nanosleep()
+class SystemClock : public Clock {
+public:
+    long monotonicUsec() override;
+    time_t now() override;
+    void sleepUsec(long usec) override;
+};
+
+// Time only moves when someone sleeps: sleepUsec() returns immediately after
+// advancing both clocks by the requested amount. Thread-safe, but concurrent
+// sleepers each advance the shared time, so it models one paced activity at a time.
+class SimulatedClock : public Clock {
+public:
+    explicit SimulatedClock(time_t start) : wallStart(start) {}
+    
+    long monotonicUsec() override;
+    time_t now() override;
+    void sleepUsec(long usec) override;
+    
+    void advanceUsec(long usec);
+    
+private:
+    std::mutex lock;
+    time_t wallStart;
+    long elapsedUsec = 0;
+};
+
+Clock& systemClock();
+
+long monotonicUsec();
@@ -0,0 +1,172 @@
+#include <iostream>
+
+#include "config.h"
+
+// A framing profile by name, keeping the current one if the name is unknown
+static const FramingProfile* loadFraming(const YAML::Node& node, const FramingProfile* current) {
+    if (!node) {
+        return current;
+    }
+    std::string name = node.as<std::string>();
+    const FramingProfile* profile = findFramingProfile(name);
+    if (!profile) {
+        std::cerr << "Warning: unknown framing '" << name << "' (p25, dmr, nxdn or none), using "
+                  << current->name << std::endl;
+        return current;
+    }
+    return profile;
+}
+
+// Payload encoding and RTP framing, keeping the current settings for anything unset or unknown
+static WireFormat loadWireFormat(const YAML::Node& node, WireFormat current) {
+    if (node["encoding"]) {
+        std::string name = node["encoding"].as<std::string>();
+        if (name == "pcm") {
+            current.encoding = WIRE_PCM;
+        } else if (name == "ulaw") {
+            current.encoding = WIRE_ULAW;
+        } else if (name == "alaw") {
+            current.encoding = WIRE_ALAW;
+        } else {
+            std::cerr << "Warning: unknown encoding '" << name << "' (pcm, ulaw or alaw), using "
+                      << current.encodingName() << std::endl;
+        }
+    }
+    current.rtp = node["rtp"].as<bool>(current.rtp);
+    return current;
+}
+
+void Config::load(const std::string& filename) {
+    try {
+        YAML::Node config = YAML::LoadFile(filename);
+        
+        if (config["network"]) {
+            host = config["network"]["host"].as<std::string>(host);
+            port = config["network"]["port"].as<int>(port);
+            resolveInterval = config["network"]["resolveInterval"].as<int>(resolveInterval);
+            shm = config["network"]["shm"].as<std::string>(shm);
+            wire = loadWireFormat(config["network"], wire);
+            if (config["network"]["multicast"]) {
+                multicastTtl = config["network"]["multicast"]["ttl"].as<int>(multicastTtl);
+                multicastInterface = config["network"]["multicast"]["interface"].as<std::string>(multicastInterface);
+                multicastLoop = config["network"]["multicast"]["loop"].as<bool>(multicastLoop);
+            }
+        }
+        
+        if (config["audio"]) {
+            leadSilence = config["audio"]["leadSilence"].as<float>(leadSilence);
+            trailSilence = config["audio"]["trailSilence"].as<float>(trailSilence);
+            settleTime = config["audio"]["settleTime"].as<float>(settleTime);
+            trimSilence = config["audio"]["trimSilence"].as<bool>(trimSilence);
+            trimThreshold = config["audio"]["trimThreshold"].as<float>(trimThreshold);
+            trimHangover = config["audio"]["trimHangover"].as<int>(trimHangover);
+            maxAirtime = config["audio"]["maxAirtime"].as<float>(maxAirtime);
+            maxSpeedup = config["audio"]["maxSpeedup"].as<float>(maxSpeedup);
+            normalize = config["audio"]["normalize"].as<bool>(normalize);
+            targetLevel = config["audio"]["targetLevel"].as<float>(targetLevel);
+            limiterCeiling = config["audio"]["limiterCeiling"].as<float>(limiterCeiling);
+            limiterLookahead = config["audio"]["limiterLookahead"].as<float>(limiterLookahead);
+            cacheDir = config["audio"]["cacheDir"].as<std::string>(cacheDir);
+            if (config["audio"]["filter"]) {
+                filter.load(config["audio"]["filter"]);
+            }
+            framing = loadFraming(config["audio"]["framing"], framing);
+        }
+        
+        if (config["tts"]) {
+            engine = config["tts"]["engine"].as<std::string>(engine);
+            
+            if (config["tts"]["espeak"]) {
+                espeakVoice = config["tts"]["espeak"]["voice"].as<std::string>(espeakVoice);
+                espeakPitch = config["tts"]["espeak"]["pitch"].as<int>(espeakPitch);
+                espeakSpeed = config["tts"]["espeak"]["speed"].as<int>(espeakSpeed);
+                espeakAmplitude = config["tts"]["espeak"]["amplitude"].as<int>(espeakAmplitude);
+            }
+            
+            if (config["tts"]["pico"]) {
+                picoLanguage = config["tts"]["pico"]["language"].as<std::string>(picoLanguage);
+            }
+            
+            if (config["tts"]["piper"]) {
+                piperModel = config["tts"]["piper"]["model"].as<std::string>(piperModel);
+                piperPath = config["tts"]["piper"]["path"].as<std::string>(piperPath);
+            }
+        }
+        
+        if (config["announcement"]) {
+            prefix = config["announcement"]["prefix"].as<std::string>(prefix);
+            use12Hour = config["announcement"]["use12Hour"].as<bool>(use12Hour);
+            includeAMPM = config["announcement"]["includeAMPM"].as<bool>(includeAMPM);
+            preAnnounceFile = config["announcement"]["preAnnounceFile"].as<std::string>(preAnnounceFile);
+            if (config["announcement"]["chime"]) {
+                for (const auto& node : config["announcement"]["chime"]) {
+                    ToneSpec tone;
+                    tone.load(node);
+                    chime.push_back(tone);
+                }
+            }
+        }
+        
+        if (config["schedule"]) {
+            scheduleInterval = config["schedule"]["interval"].as<int>(scheduleInterval);
+        }
+        
+        if (config["id"]) {
+            idEnabled = config["id"]["enabled"].as<bool>(idEnabled);
+            idCallsign = config["id"]["callsign"].as<std::string>(idCallsign);
+            idWpm = config["id"]["wpm"].as<int>(idWpm);
+            idFrequency = config["id"]["frequency"].as<float>(idFrequency);
+            idLevel = config["id"]["level"].as<float>(idLevel);
+            idInterval = config["id"]["interval"].as<int>(idInterval);
+            idStateFile = config["id"]["stateFile"].as<std::string>(idStateFile);
+        }
+        
+        if (config["busy"]) {
+            busyEnabled = config["busy"]["enabled"].as<bool>(busyEnabled);
+            busyBind = config["busy"]["bind"].as<std::string>(busyBind);
+            busyPort = config["busy"]["port"].as<int>(busyPort);
+            busyThreshold = config["busy"]["threshold"].as<float>(busyThreshold);
+            busyIdleTime = config["busy"]["idleTime"].as<int>(busyIdleTime);
+            busyMaxDefer = config["busy"]["maxDefer"].as<float>(busyMaxDefer);
+        }
+        
+        if (config["pacing"]) {
+            txTimestamps = config["pacing"]["txTimestamps"].as<bool>(txTimestamps);
+            hardwareTimestamps = config["pacing"]["hardwareTimestamps"].as<bool>(hardwareTimestamps);
+            driftPpm = config["pacing"]["driftPpm"].as<float>(driftPpm);
+            prerollFrames = config["pacing"]["preroll"].as<int>(prerollFrames);
+            sendBackend = config["pacing"]["backend"].as<std::string>(sendBackend);
+            uringBatch = config["pacing"]["uringBatch"].as<int>(uringBatch);
+        }
+        
+        if (config["capture"]) {
+            captureEnabled = config["capture"]["enabled"].as<bool>(captureEnabled);
+            capturePcap = config["capture"]["pcap"].as<bool>(capturePcap);
+            captureDir = config["capture"]["dir"].as<std::string>(captureDir);
+            captureMaxFiles = config["capture"]["maxFiles"].as<int>(captureMaxFiles);
+            captureMaxSize = config["capture"]["maxSize"].as<int>(captureMaxSize);
+        }
+        
+        if (config["destinations"]) {
+            for (const auto& node : config["destinations"]) {
+                Destination dest{node["host"].as<std::string>(host), node["port"].as<int>(port), filter, framing, "", wire};
+                if (node["filter"]) {
+                    dest.filter.load(node["filter"]);
+                }
+                dest.framing = loadFraming(node["framing"], framing);
+                dest.shm = node["shm"].as<std::string>("");
+                dest.wire = loadWireFormat(node, wire);
+                destinations.push_back(dest);
+            }
+        }
+        
+        std::cout << "Config loaded from " << filename << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Could not load config file: " << e.what() << std::endl;
+        std::cerr << "Using defaults." << std::endl;
+    }
+    
+    if (destinations.empty()) {
+        destinations.push_back(Destination{host, port, filter, framing, shm, wire});
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+#include "framing.h"
+
+// DVMBridge expects 8kHz 16-bit mono PCM
+// Send in 320-byte chunks (160 samples = 20ms frames)
+// With 4-byte big-endian length header
+constexpr int FRAME_SIZE = 320;  // bytes per frame (160 samples * 2)
+constexpr int SAMPLE_RATE = 8000;
+constexpr int MAX_DATAGRAM = 12 + FRAME_SIZE;  // Largest of any wire format: RTP header + PCM
+
+// How each frame goes on the wire. The default, 16-bit PCM behind the 4-byte
+// length header, is what DVMBridge takes; G.711 halves the bitrate for
+// receivers that accept it. RTP replaces the length header with an RTP header
+// (PCMU, PCMA, or big-endian L16 as dynamic payload type 96).
+enum WireEncoding { WIRE_PCM, WIRE_ULAW, WIRE_ALAW };
+
+struct WireFormat {
+    WireEncoding encoding = WIRE_PCM;
+    bool rtp = false;
+    
+    const char* encodingName() const {
+        return encoding == WIRE_ULAW ? "ulaw" : encoding == WIRE_ALAW ? "alaw" : "pcm";
+    }
+};
+
+// Voice-band conditioning applied before the audio reaches the IMBE/AMBE
+// vocoder: energy outside ~300-3400 Hz only costs vocoder bits and artifacts
+struct FilterSettings {
+    bool enabled = false;
+    float lowCut = 300.0f;     // Hz, high-pass corner (0 = none)
+    float highCut = 3400.0f;   // Hz, low-pass corner (0 = none)
+    float preEmphasis = 0.0f;  // dB of high-shelf boost above ~1.5 kHz (0 = none)
+    
+    void load(const YAML::Node& node) {
+        enabled = node["enabled"].as<bool>(enabled);
+        lowCut = node["lowCut"].as<float>(lowCut);
+        highCut = node["highCut"].as<float>(highCut);
+        preEmphasis = node["preEmphasis"].as<float>(preEmphasis);
+    }
+    
+    std::string signature() const {
+        if (!enabled) {
+            return "filter=off";
+        }
+        char buf[96];
+        snprintf(buf, sizeof(buf), "filter=%.1f,%.1f,%.2f", lowCut, highCut, preEmphasis);
+        return buf;
+    }
+};
+
+// One step of a generated chime: the listed frequencies played together with a
+// raised-cosine envelope. A step with no frequencies is a pause.
+struct ToneSpec {
+    std::vector<float> freqs;
+    int duration = 200;     // ms
+    float level = -12.0f;   // dBFS peak of the combined tones
+    int attack = 10;        // ms fade in
+    int release = 30;       // ms fade out
+    
+    void load(const YAML::Node& node) {
+        if (node["freqs"]) {
+            freqs = node["freqs"].as<std::vector<float>>();
+        }
+        duration = node["duration"].as<int>(duration);
+        level = node["level"].as<float>(level);
+        attack = node["attack"].as<int>(attack);
+        release = node["release"].as<int>(release);
+    }
+    
+    std::string signature() const {
+        std::string sig;
+        for (float f : freqs) {
+            sig += std::to_string(f) + "+";
+        }
+        char buf[96];
+        snprintf(buf, sizeof(buf), "/%d/%.2f/%d/%d;", duration, level, attack, release);
+        return sig + buf;
+    }
+};
+
+// A DVMBridge instance to send announcements to
+struct Destination {
+    std::string host;
+    int port;
+    FilterSettings filter;
+    const FramingProfile* framing;
+    std::string shm;  // Unix socket of a bridge on this host taking frames through shared memory
+    WireFormat wire;
+};
+
+struct Config {
+    // Network
+    std::string host = "127.0.0.1";
+    int port = 32001;
+    int resolveInterval = 300;     // Seconds before a destination's host name is looked up again
+    std::string shm = "";          // Unix socket of a local bridge's shared-memory input, instead of UDP
+    int multicastTtl = 1;              // Hop limit when a destination is a multicast group
+    std::string multicastInterface = "";  // Interface (name or IPv4 address) to send multicast from
+    bool multicastLoop = true;         // Also deliver multicast to listeners on this host
+    WireFormat wire;               // Default payload encoding and framing for all destinations
+    
+    // Audio
+    float leadSilence = 5.0f;
+    float trailSilence = 1.0f;
+    float settleTime = 2.0f;  // Seconds to wait after TTS before sending
+    bool trimSilence = false;      // Trim near-silence from TTS and pre-announce audio
+    float trimThreshold = -50.0f;  // dBFS RMS below which a 20ms frame counts as silence
+    int trimHangover = 60;         // ms of audio kept either side of the voiced part
+    float maxAirtime = 0.0f;       // Seconds; longer announcements are time-compressed (0 = off)
+    float maxSpeedup = 1.5f;       // Upper bound on the compression tempo
+    bool normalize = false;        // Normalise loudness of each segment and limit peaks
+    float targetLevel = -20.0f;    // dBFS, gated RMS target per segment
+    float limiterCeiling = -1.0f;  // dBFS, peak ceiling of the limiter
+    float limiterLookahead = 5.0f; // ms the limiter looks ahead
+    std::string cacheDir = "";     // Directory for processed audio segments (empty = no cache)
+    FilterSettings filter;         // Default voice-band filter for all destinations
+    const FramingProfile* framing = findFramingProfile("p25");  // Default protocol framing
+    
+    // Destinations (defaults to the single network host/port if none are listed)
+    std::vector<Destination> destinations;
+    
+    // TTS
+    std::string engine = "espeak";
+    
+    // espeak
+    std::string espeakVoice = "en-us+m3";
+    int espeakPitch = 40;
+    int espeakSpeed = 140;
+    int espeakAmplitude = 100;
+    
+    // pico
+    std::string picoLanguage = "en-US";
+    
+    // piper
+    std::string piperModel = "/opt/piper/en_US-lessac-medium.onnx";
+    std::string piperPath = "/opt/piper/piper";
+    
+    // Announcement
+    std::string prefix = "West Comm, time is";
+    bool use12Hour = true;
+    bool includeAMPM = true;
+    std::string preAnnounceFile = "";  // Optional sound file to play before announcement
+    std::vector<ToneSpec> chime;       // Generated chime, used instead of preAnnounceFile
+    int scheduleInterval = 60;         // Minutes between announcements in --daemon mode
+    
+    // CW (Morse) station ID
+    bool idEnabled = false;
+    std::string idCallsign = "";
+    int idWpm = 20;
+    float idFrequency = 800.0f;        // Hz
+    float idLevel = -14.0f;            // dBFS
+    int idInterval = 60;               // Minutes between IDs (0 = every announcement)
+    std::string idStateFile = "/tmp/time-announce-id.last";  // Time of the last ID
+    
+    // Channel-busy deferral (monitors DVMBridge's received audio)
+    bool busyEnabled = false;
+    std::string busyBind = "0.0.0.0";
+    int busyPort = 32002;
+    float busyThreshold = -45.0f;      // dBFS RMS per 20ms frame that counts as traffic
+    int busyIdleTime = 2000;           // ms of quiet required before transmitting
+    float busyMaxDefer = 60.0f;        // Seconds to hold at most, then send anyway
+    
+    // Pacing diagnostics
+    bool txTimestamps = false;         // Report where each frame's send time goes, and wire jitter
+    bool hardwareTimestamps = false;   // Also ask the NIC for TX timestamps (needs HW support)
+    float driftPpm = 0.0f;             // Bridge clock rate relative to ours (dvm-sink measures it)
+    int prerollFrames = 0;             // Frames of lead silence sent ahead of real time
+    std::string sendBackend = "threads";  // "threads" (one per destination) or "uring" (one for all)
+    int uringBatch = 8;                // Frames per destination queued ahead with the uring backend
+    
+    // Capture of what is transmitted, written off the pacing path
+    bool captureEnabled = false;       // WAV + CSV of the frames sent
+    bool capturePcap = false;          // pcap of the datagrams sent, with kernel TX timestamps
+    std::string captureDir = "/tmp";
+    int captureMaxFiles = 48;          // Oldest announcements' captures are deleted beyond this (0 = keep all)
+    int captureMaxSize = 10;           // MB per file before starting a new part (0 = no limit)
+    
+    void load(const std::string& filename);
+    
+    // Settings that change how a segment is processed, for cache keys
+    std::string dspSignature() const {
+        char buf[160];
+        snprintf(buf, sizeof(buf), "trim=%d,%.2f,%d|norm=%d,%.2f,%.2f,%.2f",
+                 trimSilence, trimThreshold, trimHangover,
+                 normalize, targetLevel, limiterCeiling, limiterLookahead);
+        return buf;
+    }
+};
@@ -0,0 +1,300 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "dsp.h"
+
+// Sum of squares over a block of samples. Kept branch-free with a 64-bit
+// accumulator so the compiler can vectorise it.
+int64_t blockEnergy(const int16_t* x, size_t n) {
+    int64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t s = x[i];
+        acc += s * s;
+    }
+    return acc;
+}
+
+// Drop leading and trailing near-silence. Energy is measured over 20ms frames;
+// frames below thresholdDb (dBFS RMS) at either end are removed, keeping
+// hangoverMs of audio around the voiced part so soft onsets and word tails survive.
+void trimSilence(std::vector<int16_t>& samples, float thresholdDb, int hangoverMs) {
+    const size_t frameLen = SAMPLE_RATE / 50;  // 160 samples = 20ms
+    if (samples.size() < frameLen) {
+        return;
+    }
+
+    // Threshold as energy per full frame: (10^(dB/20) * 32768)^2 * frameLen
+    double level = pow(10.0, thresholdDb / 20.0) * 32768.0;
+    double threshold = level * level * frameLen;
+
+    size_t frames = (samples.size() + frameLen - 1) / frameLen;
+    auto voiced = [&](size_t f) {
+        size_t start = f * frameLen;
+        size_t n = std::min(frameLen, samples.size() - start);
+        // Scale the threshold for a short final frame
+        return (double)blockEnergy(samples.data() + start, n) >= threshold * n / frameLen;
+    };
+
+    size_t first = 0;
+    while (first < frames && !voiced(first)) first++;
+    if (first == frames) {
+        std::cerr << "Warning: audio is entirely below trim threshold, leaving untouched" << std::endl;
+        return;
+    }
+    size_t last = frames - 1;
+    while (last > first && !voiced(last)) last--;
+
+    size_t hangover = static_cast<size_t>(hangoverMs) * SAMPLE_RATE / 1000;
+    size_t begin = first * frameLen;
+    begin = (begin > hangover) ? begin - hangover : 0;
+    size_t end = std::min(samples.size(), (last + 1) * frameLen + hangover);
+
+    size_t before = samples.size();
+    samples.erase(samples.begin() + end, samples.end());
+    samples.erase(samples.begin(), samples.begin() + begin);
+
+    std::cout << "Trimmed silence: " << begin * 1000 / SAMPLE_RATE << " ms lead, "
+              << (before - end) * 1000 / SAMPLE_RATE << " ms tail" << std::endl;
+}
+
+// Dot product with independent partial sums, so it vectorises without
+// needing -ffast-math to reorder a single accumulator.
+float dotProduct(const float* a, const float* b, size_t n) {
+    float acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k < 8; k++) {
+            acc[k] += a[i + k] * b[i + k];
+        }
+    }
+    float sum = 0;
+    for (int k = 0; k < 8; k++) sum += acc[k];
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// Speed speech up by `tempo` (> 1 = shorter) without changing pitch, using
+// WSOLA: 30ms Hann-windowed frames are overlap-added at a fixed synthesis hop,
+// and each analysis frame is picked within +/- an 8ms tolerance of its nominal
+// position so that it best continues the previous one (max cross-correlation).
+std::vector<int16_t> timeCompress(const std::vector<int16_t>& in, double tempo) {
+    const int N = 240;          // 30ms window
+    const int Hs = N / 2;       // synthesis hop, 50% overlap
+    const int tolerance = 64;   // 8ms, longer than a pitch period for most voices
+
+    if (tempo <= 1.0 || in.size() < static_cast<size_t>(2 * N)) {
+        return in;
+    }
+
+    // Float copy, zero padded so every candidate frame stays in range
+    std::vector<float> x(in.size() + 2 * N + 2 * tolerance, 0.0f);
+    for (size_t i = 0; i < in.size(); i++) {
+        x[i] = in[i];
+    }
+    const long maxStart = static_cast<long>(x.size()) - N;
+
+    float window[N];
+    for (int i = 0; i < N; i++) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * static_cast<float>(M_PI) * i / N);
+    }
+
+    size_t outLen = static_cast<size_t>(in.size() / tempo);
+    std::vector<float> y(outLen + N, 0.0f);
+    std::vector<float> weight(outLen + N, 0.0f);
+    const double Ha = Hs * tempo;
+
+    long prev = 0;
+    for (size_t k = 0; k * Hs < outLen; k++) {
+        long pos = 0;
+        if (k > 0) {
+            long nominal = std::lround(k * Ha);
+            long natural = std::min(prev + Hs, maxStart);  // where the last frame would carry on
+            long lo = std::max(0L, nominal - tolerance);
+            long hi = std::min(maxStart, nominal + tolerance);
+            pos = std::min(nominal, maxStart);
+            float best = -INFINITY;
+            for (long p = lo; p <= hi; p++) {
+                float score = dotProduct(&x[natural], &x[p], N);
+                if (score > best) {
+                    best = score;
+                    pos = p;
+                }
+            }
+        }
+
+        float* out = &y[k * Hs];
+        float* w = &weight[k * Hs];
+        const float* src = &x[pos];
+        for (int i = 0; i < N; i++) {
+            out[i] += window[i] * src[i];
+            w[i] += window[i];
+        }
+        prev = pos;
+    }
+
+    std::vector<int16_t> result(outLen);
+    for (size_t i = 0; i < outLen; i++) {
+        float v = weight[i] > 1e-3f ? y[i] / weight[i] : y[i];
+        v = std::max(-32768.0f, std::min(32767.0f, v));
+        result[i] = static_cast<int16_t>(std::lrint(v));
+    }
+    return result;
+}
+
+// Bring a segment to a target loudness, then run a look-ahead peak limiter so
+// the int16 result never clips. Loudness is the RMS of the 20ms frames above
+// -60 dBFS (a crude gate, like LUFS, so pauses don't drag the measurement down).
+void normalizeLoudness(std::vector<int16_t>& samples, float targetDb, float ceilingDb, float lookaheadMs) {
+    const size_t frameLen = SAMPLE_RATE / 50;
+    const double gate = pow(10.0, -60.0 / 10.0) * 32768.0 * 32768.0 * frameLen;
+
+    double energy = 0;
+    size_t gatedSamples = 0;
+    for (size_t start = 0; start + frameLen <= samples.size(); start += frameLen) {
+        double e = (double)blockEnergy(samples.data() + start, frameLen);
+        if (e >= gate) {
+            energy += e;
+            gatedSamples += frameLen;
+        }
+    }
+    if (gatedSamples == 0) {
+        return;
+    }
+
+    double levelDb = 10.0 * log10(energy / gatedSamples / (32768.0 * 32768.0));
+    // Cap the boost so a near-silent segment isn't turned into amplified noise
+    float gain = static_cast<float>(pow(10.0, std::min(24.0, targetDb - levelDb) / 20.0));
+    const float ceiling = static_cast<float>(pow(10.0, ceilingDb / 20.0) * 32767.0);
+    const size_t n = samples.size();
+    const size_t la = std::max<size_t>(1, static_cast<size_t>(lookaheadMs * SAMPLE_RATE / 1000));
+
+    // Gain needed per sample to stay under the ceiling
+    std::vector<float> x(n), need(n + la, 1.0f);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = samples[i] * gain;
+        need[i] = std::min(1.0f, ceiling / std::max(fabsf(x[i]), 1.0f));
+    }
+
+    // Minimum over the look-ahead window, so gain reduction starts early...
+    std::vector<float> ahead(need.begin(), need.begin() + n);
+    for (size_t k = 1; k <= la; k++) {
+        const float* src = need.data() + k;
+        for (size_t i = 0; i < n; i++) {
+            ahead[i] = std::min(ahead[i], src[i]);
+        }
+    }
+
+    // ...then averaged over the same length so it ramps rather than steps. Every
+    // term in the average covers sample i, so the result never exceeds need[i].
+    std::vector<float> smooth(n);
+    double run = 0;
+    for (size_t i = 0; i < n; i++) {
+        run += ahead[i];
+        if (i >= la) run -= ahead[i - la];
+        smooth[i] = static_cast<float>(run / std::min(i + 1, la));
+    }
+
+    // Release: recover towards unity gain over ~50ms, but follow reductions immediately
+    const float release = 1.0f - expf(-1.0f / (0.050f * SAMPLE_RATE));
+    float env = 1.0f;
+    size_t limited = 0;
+    for (size_t i = 0; i < n; i++) {
+        env = smooth[i] < env ? smooth[i] : env + (smooth[i] - env) * release;
+        if (env < 0.999f) limited++;
+        float v = std::max(-32768.0f, std::min(32767.0f, x[i] * env));
+        samples[i] = static_cast<int16_t>(std::lrint(v));
+    }
+
+    std::cout << "Normalised " << levelDb << " dBFS -> " << targetDb << " dBFS ("
+              << limited * 1000 / SAMPLE_RATE << " ms limited)" << std::endl;
+}
+
+// One second-order section, transposed direct form II (RBJ cookbook designs)
+struct Biquad {
+    float b0, b1, b2, a1, a2;
+    float z1 = 0, z2 = 0;
+    
+    static Biquad lowPass(float f0, float q) {
+        float w = 2.0f * static_cast<float>(M_PI) * f0 / SAMPLE_RATE;
+        float alpha = sinf(w) / (2.0f * q), c = cosf(w), a0 = 1.0f + alpha;
+        return Biquad{(1 - c) / 2 / a0, (1 - c) / a0, (1 - c) / 2 / a0, -2 * c / a0, (1 - alpha) / a0};
+    }
+    
+    static Biquad highPass(float f0, float q) {
+        float w = 2.0f * static_cast<float>(M_PI) * f0 / SAMPLE_RATE;
+        float alpha = sinf(w) / (2.0f * q), c = cosf(w), a0 = 1.0f + alpha;
+        return Biquad{(1 + c) / 2 / a0, -(1 + c) / a0, (1 + c) / 2 / a0, -2 * c / a0, (1 - alpha) / a0};
+    }
+    
+    static Biquad highShelf(float f0, float gainDb) {
+        float A = powf(10.0f, gainDb / 40.0f);
+        float w = 2.0f * static_cast<float>(M_PI) * f0 / SAMPLE_RATE;
+        float c = cosf(w), beta = 2.0f * sqrtf(A) * sinf(w) / 2.0f * sqrtf(2.0f);
+        float a0 = (A + 1) - (A - 1) * c + beta;
+        return Biquad{A * ((A + 1) + (A - 1) * c + beta) / a0,
+                      -2 * A * ((A - 1) + (A + 1) * c) / a0,
+                      A * ((A + 1) + (A - 1) * c - beta) / a0,
+                      2 * ((A - 1) - (A + 1) * c) / a0,
+                      ((A + 1) - (A - 1) * c - beta) / a0};
+    }
+    
+    void process(float* x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            float y = b0 * x[i] + z1;
+            z1 = b1 * x[i] - a1 * y + z2;
+            z2 = b2 * x[i] - a2 * y;
+            x[i] = y;
+        }
+    }
+};
+
+// Band-limit (4th-order Butterworth high- and low-pass) and optionally
+// pre-emphasise a segment. Works in fixed-size float blocks: the int16
+// conversions vectorise, and running each section over a whole block keeps
+// its coefficients and state in registers through the recursion.
+void applyVoiceFilter(std::vector<int16_t>& samples, const FilterSettings& settings) {
+    if (!settings.enabled || samples.empty()) {
+        return;
+    }
+
+    // Q values of the two sections of a 4th-order Butterworth
+    const float q1 = 0.5412f, q2 = 1.3066f;
+    std::vector<Biquad> cascade;
+    if (settings.lowCut > 0) {
+        cascade.push_back(Biquad::highPass(settings.lowCut, q1));
+        cascade.push_back(Biquad::highPass(settings.lowCut, q2));
+    }
+    if (settings.highCut > 0 && settings.highCut < SAMPLE_RATE / 2) {
+        cascade.push_back(Biquad::lowPass(settings.highCut, q1));
+        cascade.push_back(Biquad::lowPass(settings.highCut, q2));
+    }
+    if (settings.preEmphasis != 0) {
+        cascade.push_back(Biquad::highShelf(1500.0f, settings.preEmphasis));
+    }
+
+    constexpr size_t BLOCK = 256;
+    float block[BLOCK];
+    for (size_t start = 0; start < samples.size(); start += BLOCK) {
+        size_t n = std::min(BLOCK, samples.size() - start);
+        int16_t* pcm = samples.data() + start;
+        for (size_t i = 0; i < n; i++) {
+            block[i] = pcm[i];
+        }
+        for (auto& section : cascade) {
+            section.process(block, n);
+        }
+        for (size_t i = 0; i < n; i++) {
+            float v = std::max(-32768.0f, std::min(32767.0f, block[i]));
+            pcm[i] = static_cast<int16_t>(std::lrint(v));
+        }
+    }
+}
+
+// Append zero samples until the length is a multiple of `boundary`
+void padToBoundary(std::vector<int16_t>& samples, size_t boundary) {
+    size_t remainder = samples.size() % boundary;
+    if (remainder != 0) {
+        samples.resize(samples.size() + boundary - remainder, 0);
+    }
+}
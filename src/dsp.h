@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "config.h"
+
+int64_t blockEnergy(const int16_t* x, size_t n);
+void trimSilence(std::vector<int16_t>& samples, float thresholdDb, int hangoverMs);
+float dotProduct(const float* a, const float* b, size_t n);
+std::vector<int16_t> timeCompress(const std::vector<int16_t>& in, double tempo);
+void normalizeLoudness(std::vector<int16_t>& samples, float targetDb, float ceilingDb, float lookaheadMs);
+void applyVoiceFilter(std::vector<int16_t>& samples, const FilterSettings& settings);
+void padToBoundary(std::vector<int16_t>& samples, size_t boundary);
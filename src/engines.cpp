@@ -0,0 +1,164 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "engines.h"
+
+// Append raw 16-bit samples from a file or pipe until EOF, reading in blocks
+// rather than a sample per fread call
+void readSamples(FILE* f, std::vector<int16_t>& samples) {
+    int16_t block[4096];
+    size_t n;
+    while ((n = fread(block, sizeof(int16_t), 4096, f)) > 0) {
+        samples.insert(samples.end(), block, block + n);
+    }
+}
+
+std::vector<int16_t> loadPreAnnounceAudio(const std::string& filename) {
+    std::vector<int16_t> samples;
+    
+    if (filename.empty()) {
+        return samples;
+    }
+    
+    // Use sox to convert to raw 8kHz 16-bit mono (in case it isn't already)
+    // Use PID in temp filename to avoid collisions
+    int pid = getpid();
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd),
+             "sox \"%s\" -r 8000 -b 16 -c 1 -t raw /tmp/preannounce_%d.raw 2>/dev/null && sync",
+             filename.c_str(), pid);
+    
+    int ret = system(cmd);
+    if (ret != 0) {
+        std::cerr << "Failed to convert pre-announce file: " << filename << std::endl;
+        return samples;
+    }
+    
+    // Read the raw file directly
+    char rawPath[64];
+    snprintf(rawPath, sizeof(rawPath), "/tmp/preannounce_%d.raw", pid);
+    
+    FILE* rawFile = fopen(rawPath, "rb");
+    if (!rawFile) {
+        std::cerr << "Failed to open " << rawPath << std::endl;
+        return samples;
+    }
+    
+    readSamples(rawFile, samples);
+    
+    fclose(rawFile);
+    
+    std::cout << "Loaded pre-announce audio: " << samples.size() << " samples (" 
+              << (float)samples.size() / SAMPLE_RATE << " seconds)" << std::endl;
+    
+    return samples;
+}
+
+// Run the configured TTS engine and read back its 8kHz output (untrimmed)
+bool synthesizeSpeech(const std::string& text, const Config& config, std::vector<int16_t>& speech) {
+    std::string cmd;
+    
+    if (config.engine == "piper") {
+        // Use piper - use unique temp files to avoid race conditions
+        // Two-step: piper -> wav, then sox -> raw, then read directly
+        int pid = getpid();
+        char piperCmd[768];
+        snprintf(piperCmd, sizeof(piperCmd),
+                 "echo \"%s\" | %s --model %s --output_file /tmp/piper_%d.wav >/dev/null 2>&1 && "
+                 "sox /tmp/piper_%d.wav -r 8000 -b 16 -c 1 -t raw /tmp/piper_%d.raw && "
+                 "sync",
+                 text.c_str(),
+                 config.piperPath.c_str(),
+                 config.piperModel.c_str(),
+                 pid, pid, pid);
+        
+        std::cout << "TTS command: " << piperCmd << std::endl;
+        
+        // Run the command to generate the files
+        int ret = system(piperCmd);
+        if (ret != 0) {
+            std::cerr << "Piper command failed" << std::endl;
+            return false;
+        }
+        
+        // Read the raw file directly
+        char rawPath[64];
+        snprintf(rawPath, sizeof(rawPath), "/tmp/piper_%d.raw", pid);
+        
+        FILE* rawFile = fopen(rawPath, "rb");
+        if (!rawFile) {
+            std::cerr << "Failed to open " << rawPath << std::endl;
+            return false;
+        }
+        
+        readSamples(rawFile, speech);
+        
+        fclose(rawFile);
+        
+        std::cout << "Loaded piper audio: " << speech.size() << " TTS samples" << std::endl;
+        
+    } else {
+        // pico or espeak - use popen approach
+        if (config.engine == "pico") {
+            // Use pico2wave
+            cmd = "pico2wave -l " + config.picoLanguage + " -w /tmp/tts_temp.wav \"" + text + "\" && "
+                  "sox /tmp/tts_temp.wav -r 8000 -b 16 -c 1 -t raw -";
+        } else {
+            // Use espeak-ng (default)
+            char espeakCmd[512];
+            snprintf(espeakCmd, sizeof(espeakCmd),
+                     "espeak-ng -v %s -p %d -s %d -a %d \"%s\" --stdout | "
+                     "sox -t wav - -r 8000 -b 16 -c 1 -t raw -",
+                     config.espeakVoice.c_str(),
+                     config.espeakPitch,
+                     config.espeakSpeed,
+                     config.espeakAmplitude,
+                     text.c_str());
+            cmd = espeakCmd;
+        }
+        
+        std::cout << "TTS command: " << cmd << std::endl;
+        
+        FILE* pipe = popen(cmd.c_str(), "r");
+        if (!pipe) {
+            std::cerr << "Failed to run TTS command" << std::endl;
+            return false;
+        }
+
+        readSamples(pipe, speech);
+
+        // A missing engine or sox still gives us a pipe, just an empty one
+        int status = pclose(pipe);
+        if (status != 0) {
+            std::cerr << "TTS command failed (exit status "
+                      << (WIFEXITED(status) ? WEXITSTATUS(status) : -1) << ")" << std::endl;
+            speech.clear();
+            return false;
+        }
+    }
+    
+    if (speech.empty()) {
+        std::cerr << "TTS engine produced no audio" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Identifies everything that changes a processed speech segment, so cached
+// audio is only reused while the engine and DSP settings still match
+std::string speechCacheKey(const std::string& text, const Config& config) {
+    std::string key = "tts|" + config.engine + "|";
+    if (config.engine == "piper") {
+        key += config.piperPath + "|" + config.piperModel;
+    } else if (config.engine == "pico") {
+        key += config.picoLanguage;
+    } else {
+        key += config.espeakVoice + "|" + std::to_string(config.espeakPitch) + "|" +
+               std::to_string(config.espeakSpeed) + "|" + std::to_string(config.espeakAmplitude);
+    }
+    return key + "|" + text + "|" + config.dspSignature() + "|air=" +
+           std::to_string(config.maxAirtime) + "," + std::to_string(config.maxSpeedup);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+void readSamples(FILE* f, std::vector<int16_t>& samples);
+std::vector<int16_t> loadPreAnnounceAudio(const std::string& filename);
+bool synthesizeSpeech(const std::string& text, const Config& config, std::vector<int16_t>& speech);
+std::string speechCacheKey(const std::string& text, const Config& config);
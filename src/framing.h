@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+// How a digital voice protocol groups 20ms vocoder frames into the units it
+// puts on air. The bridge encodes the audio it receives a unit at a time, so
+// the lead silence is rounded up to whole units (speech starts on a unit
+// boundary) and the end padded to complete the last unit, rather than leaving
+// the bridge to fill it out. Smaller units mean less padding on every call.
+struct FramingProfile {
+    const char* name;
+    const char* unit;  // What one unit is called, for log output
+    int unitSamples;   // 8kHz samples per unit
+};
+
+// p25: 9 IMBE frames per LDU (180ms); dmr: 3 AMBE+2 frames per voice burst
+// (60ms); nxdn: 4 AMBE+2 frames per voice frame (80ms); none: no grouping
+// beyond the 20ms frames themselves. nullptr for an unknown name.
+inline const FramingProfile* findFramingProfile(const std::string& name) {
+    static const FramingProfile profiles[] = {
+        {"p25", "LDU", 9 * 160},
+        {"dmr", "burst", 3 * 160},
+        {"nxdn", "voice frame", 4 * 160},
+        {"none", "frame", 160},
+    };
+    for (const FramingProfile& profile : profiles) {
+        if (name == profile.name) {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
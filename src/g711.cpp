@@ -0,0 +1,117 @@
+#include "g711.h"
+
+// Segment end points of the 14-bit (mu-law) and 13-bit (A-law) magnitudes
+static const int ULAW_SEGMENT_END[8] = {0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF};
+static const int ALAW_SEGMENT_END[8] = {0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF};
+
+static int segment(int value, const int* ends) {
+    int seg = 0;
+    while (seg < 8 && value > ends[seg]) {
+        seg++;
+    }
+    return seg;
+}
+
+// value: a 14-bit signed sample
+static uint8_t ulawFromLinear(int value) {
+    int mask = 0xFF;
+    if (value < 0) {
+        value = -value;
+        mask = 0x7F;
+    }
+    if (value > 8159) {
+        value = 8159;
+    }
+    value += 0x84 >> 2;
+    int seg = segment(value, ULAW_SEGMENT_END);
+    if (seg >= 8) {
+        return 0x7F ^ mask;
+    }
+    return ((seg << 4) | ((value >> (seg + 1)) & 0x0F)) ^ mask;
+}
+
+// value: a 13-bit signed sample
+static uint8_t alawFromLinear(int value) {
+    int mask = 0xD5;
+    if (value < 0) {
+        value = -value - 1;
+        mask = 0x55;
+    }
+    int seg = segment(value, ALAW_SEGMENT_END);
+    if (seg >= 8) {
+        return 0x7F ^ mask;
+    }
+    int code = seg << 4;
+    code |= (seg < 2 ? value >> 1 : value >> seg) & 0x0F;
+    return code ^ mask;
+}
+
+static int16_t linearFromULaw(uint8_t code) {
+    code = ~code;
+    int t = (((code & 0x0F) << 3) + 0x84) << ((code & 0x70) >> 4);
+    return (code & 0x80) ? 0x84 - t : t - 0x84;
+}
+
+static int16_t linearFromALaw(uint8_t code) {
+    code ^= 0x55;
+    int t = (code & 0x0F) << 4;
+    int seg = (code & 0x70) >> 4;
+    t += seg == 0 ? 8 : 0x108;
+    if (seg > 1) {
+        t <<= seg - 1;
+    }
+    return (code & 0x80) ? t : -t;
+}
+
+struct G711Tables {
+    uint8_t ulaw[1 << 14];
+    uint8_t alaw[1 << 13];
+    int16_t fromULaw[256];
+    int16_t fromALaw[256];
+
+    G711Tables() {
+        for (int i = 0; i < (1 << 14); i++) {
+            ulaw[i] = ulawFromLinear(static_cast<int16_t>(i << 2) >> 2);
+        }
+        for (int i = 0; i < (1 << 13); i++) {
+            alaw[i] = alawFromLinear(static_cast<int16_t>(i << 3) >> 3);
+        }
+        for (int i = 0; i < 256; i++) {
+            fromULaw[i] = linearFromULaw(i);
+            fromALaw[i] = linearFromALaw(i);
+        }
+    }
+};
+
+static const G711Tables& tables() {
+    static const G711Tables t;
+    return t;
+}
+
+void encodeULaw(const int16_t* in, uint8_t* out, size_t samples) {
+    const uint8_t* table = tables().ulaw;
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = table[static_cast<uint16_t>(in[i]) >> 2];
+    }
+}
+
+void encodeALaw(const int16_t* in, uint8_t* out, size_t samples) {
+    const uint8_t* table = tables().alaw;
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = table[static_cast<uint16_t>(in[i]) >> 3];
+    }
+}
+
+void decodeULaw(const uint8_t* in, int16_t* out, size_t samples) {
+    const int16_t* table = tables().fromULaw;
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = table[in[i]];
+    }
+}
+
+void decodeALaw(const uint8_t* in, int16_t* out, size_t samples) {
+    const int16_t* table = tables().fromALaw;
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = table[in[i]];
+    }
+}
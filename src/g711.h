@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// G.711 mu-law and A-law, table driven. Encoding looks each sample up by its
+// top 14 (mu-law) or 13 (A-law) bits, which is all G.711 uses, and decoding by
+// the code byte. The tables are built on first use.
+void encodeULaw(const int16_t* in, uint8_t* out, size_t samples);
+void encodeALaw(const int16_t* in, uint8_t* out, size_t samples);
+void decodeULaw(const uint8_t* in, int16_t* out, size_t samples);
+void decodeALaw(const uint8_t* in, int16_t* out, size_t samples);
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <time.h>
+
+#include "pacing_stats.h"
+
+// Percentiles of a set of delays, in microseconds
+static void printDelays(const char* what, std::vector<double> usec) {
+    if (usec.empty()) {
+        char line[64];
+        snprintf(line, sizeof(line), "  %-22s no data", what);
+        std::cout << line << std::endl;
+        return;
+    }
+    std::sort(usec.begin(), usec.end());
+    double sum = 0;
+    for (double v : usec) {
+        sum += v;
+    }
+    auto at = [&](double p) { return usec[std::min(usec.size() - 1, (size_t)(p * usec.size()))]; };
+    char line[128];
+    snprintf(line, sizeof(line), "  %-22s mean %8.1f  p50 %8.1f  p99 %8.1f  max %8.1f us",
+             what, sum / usec.size(), at(0.5), at(0.99), usec.back());
+    std::cout << line << std::endl;
+}
+
+void PacingStats::begin(size_t count, long start) {
+    frames.assign(count, Frame());
+    startUsec = start;
+
+    struct timespec real, mono;
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    realOffsetNs = (real.tv_sec - mono.tv_sec) * 1000000000LL + (real.tv_nsec - mono.tv_nsec);
+}
+
+void PacingStats::sent(long index, long targetUsec, long callUsec, long returnUsec) {
+    if (index < 0 || index >= (long)frames.size()) {
+        return;
+    }
+    frames[index].targetUsec = targetUsec;
+    frames[index].callUsec = callUsec;
+    frames[index].returnUsec = returnUsec;
+}
+
+void PacingStats::stamp(const TxStamp& stamp) {
+    if (stamp.index < 0 || stamp.index >= (long)frames.size()) {
+        return;
+    }
+    Frame& frame = frames[stamp.index];
+    if (stamp.type == TX_SCHED) {
+        frame.schedNs = stamp.ns;
+    } else if (stamp.type == TX_SOFTWARE) {
+        frame.softwareNs = stamp.ns;
+    } else {
+        frame.hardwareNs = stamp.ns;
+    }
+}
+
+void PacingStats::report(const std::string& label) const {
+    std::vector<double> wakeup, syscall, stack, qdisc;
+    bool allHardware = !frames.empty();
+    size_t stamped = 0;
+    for (const Frame& f : frames) {
+        if (f.callUsec < 0) {
+            allHardware = false;
+            continue;
+        }
+        wakeup.push_back(f.callUsec - startUsec - f.targetUsec);
+        syscall.push_back(f.returnUsec - f.callUsec);
+        long long callNs = f.callUsec * 1000LL + realOffsetNs;
+        if (f.schedNs >= 0) {
+            stack.push_back((f.schedNs - callNs) / 1000.0);
+            if (f.softwareNs >= 0) {
+                qdisc.push_back((f.softwareNs - f.schedNs) / 1000.0);
+            }
+        }
+        stamped += f.softwareNs >= 0 || f.hardwareNs >= 0;
+        allHardware = allHardware && f.hardwareNs >= 0;
+    }
+
+    std::cout << "Pacing " << label << ": " << frames.size() << " frames, " << stamped << " with TX timestamps"
+              << (allHardware ? " (hardware)" : "") << std::endl;
+    printDelays("late wakeup", wakeup);
+    printDelays("sendto()", syscall);
+    printDelays("stack to qdisc", stack);
+    printDelays("qdisc to driver", qdisc);
+
+    // Inter-departure deviation from the intended spacing (20ms, or none within
+    // a pre-roll burst), on the wire as far as we can see it
+    static const long bounds[] = {10, 50, 100, 250, 500, 1000, 2000, 5000, 10000};
+    const size_t buckets = sizeof(bounds) / sizeof(bounds[0]) + 1;
+    long counts[buckets] = {0};
+    long total = 0;
+    long long prev = -1;
+    long prevTarget = 0;
+    for (const Frame& f : frames) {
+        long long departed = allHardware ? f.hardwareNs : f.softwareNs;
+        if (departed < 0) {
+            prev = -1;
+            continue;
+        }
+        if (prev >= 0) {
+            long deviation = labs((long)((departed - prev) / 1000) - (f.targetUsec - prevTarget));
+            size_t b = 0;
+            while (b < buckets - 1 && deviation >= bounds[b]) {
+                b++;
+            }
+            counts[b]++;
+            total++;
+        }
+        prev = departed;
+        prevTarget = f.targetUsec;
+    }
+    if (total == 0) {
+        std::cout << "  No wire timestamps; the kernel did not report any" << std::endl;
+        return;
+    }
+    std::cout << "  Wire jitter, |inter-departure - intended|:" << std::endl;
+    for (size_t b = 0; b < buckets; b++) {
+        char range[32];
+        if (b == buckets - 1) {
+            snprintf(range, sizeof(range), ">= %ld us", bounds[b - 1]);
+        } else {
+            snprintf(range, sizeof(range), "< %ld us", bounds[b]);
+        }
+        int bar = (int)(counts[b] * 40 / total);
+        char line[96];
+        snprintf(line, sizeof(line), "    %-12s %6ld  %5.1f%%  ", range, counts[b], 100.0 * counts[b] / total);
+        std::cout << line << std::string(bar, '#') << std::endl;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "txstamp.h"
+
+// Where the time between "this frame is due" and "this frame left the host"
+// goes, per frame of a transmission: user-space scheduling (waking up late,
+// the sendto() call), the kernel stack up to the qdisc, the qdisc itself, and
+// optionally the NIC. The departure times (hardware stamps if every frame has
+// one, otherwise the driver hand-off) give the wire-level jitter histogram.
+class PacingStats {
+public:
+    // Called before the first frame; times are in the sender's monotonic clock
+    void begin(size_t frames, long startUsec);
+
+    // targetUsec is when the frame was due, relative to startUsec
+    void sent(long index, long targetUsec, long callUsec, long returnUsec);
+    void stamp(const TxStamp& stamp);
+
+    void report(const std::string& label) const;
+
+private:
+    struct Frame {
+        long targetUsec = -1;
+        long callUsec = -1;
+        long returnUsec = -1;
+        long long schedNs = -1;
+        long long softwareNs = -1;
+        long long hardwareNs = -1;
+    };
+
+    std::vector<Frame> frames;
+    long startUsec = 0;
+    long long realOffsetNs = 0;  // CLOCK_REALTIME - CLOCK_MONOTONIC, to compare with stamps
+};
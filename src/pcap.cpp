@@ -0,0 +1,260 @@
+#include <iostream>
+#include <cstring>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "capture.h"
+#include "pcap.h"
+
+static const uint32_t PCAP_MAGIC_NSEC = 0xa1b23c4d;
+static const uint32_t LINKTYPE_RAW = 101;  // Packets start with the IP header
+
+// Ones' complement sum for IP/UDP checksums, folded to 16 bits
+static uint32_t checksumAdd(uint32_t sum, const uint8_t* data, size_t bytes) {
+    for (size_t i = 0; i + 1 < bytes; i += 2) {
+        sum += (data[i] << 8) | data[i + 1];
+    }
+    if (bytes & 1) {
+        sum += data[bytes - 1] << 8;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return sum;
+}
+
+PacketCapture::~PacketCapture() {
+    stop();
+}
+
+bool PacketCapture::start(time_t when) {
+    basePath = captureBasePath(config, when, suffix);
+    if (!openPart()) {
+        return false;
+    }
+    running = true;
+    worker = std::thread(&PacketCapture::run, this);
+    return true;
+}
+
+void PacketCapture::stop() {
+    if (running) {
+        running = false;
+        worker.join();
+        closePart();
+        std::cout << "Captured " << written << " packets, " << kernelStamps
+                  << " with kernel TX timestamps" << std::endl;
+        if (droppedPackets) {
+            std::cerr << "Warning: pcap capture dropped " << droppedPackets << " packets" << std::endl;
+        }
+    }
+}
+
+void PacketCapture::attach(int sock, Clock& clock) {
+    // The socket is connected, so both ends are known
+    socklen_t len = sizeof(srcAddr);
+    getsockname(sock, (struct sockaddr*)&srcAddr, &len);
+    len = sizeof(destAddr);
+    getpeername(sock, (struct sockaddr*)&destAddr, &len);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    wallOffsetUsec = now.tv_sec * 1000000L + now.tv_nsec / 1000L - clock.monotonicUsec();
+}
+
+bool PacketCapture::push(const uint8_t* datagram, size_t bytes, long index, long usec) {
+    if (!running) {
+        return false;
+    }
+    Slot* slot = ring.claim();
+    if (!slot) {
+        droppedPackets++;
+        return false;
+    }
+    slot->index = index;
+    slot->usec = usec;
+    slot->bytes = static_cast<uint16_t>(std::min(bytes, sizeof(slot->data)));
+    memcpy(slot->data, datagram, slot->bytes);
+    ring.publish();
+    return true;
+}
+
+bool PacketCapture::stamp(long index, long long ns) {
+    if (!running) {
+        return false;
+    }
+    Stamp* slot = stampRing.claim();
+    if (!slot) {
+        return false;
+    }
+    slot->index = index;
+    slot->ns = ns;
+    stampRing.publish();
+    return true;
+}
+
+void PacketCapture::run() {
+    while (true) {
+        bool stopping = !running;
+        bool idle = true;
+        while (Slot* slot = ring.front()) {
+            pending.push_back(*slot);
+            pending.back().queuedUsec = monotonicUsec();
+            ring.pop();
+            idle = false;
+        }
+
+        while (Stamp* stamp = stampRing.front()) {
+            txStamps[stamp->index] = stamp->ns;
+            stampRing.pop();
+        }
+        flush(stopping);
+
+        if (stopping) {
+            break;
+        }
+        if (idle) {
+            usleep(5000);
+        }
+    }
+}
+
+// Write out pending datagrams in order, each as soon as its kernel timestamp
+// is in. One that hasn't been stamped within 200ms never will be.
+void PacketCapture::flush(bool all) {
+    long now = monotonicUsec();
+    while (!pending.empty()) {
+        const Slot& slot = pending.front();
+        auto stamp = txStamps.find(slot.index);
+        if (stamp != txStamps.end()) {
+            write(slot, stamp->second);
+            kernelStamps++;
+            txStamps.erase(txStamps.begin(), ++stamp);
+        } else if (all || now - slot.queuedUsec > 200000) {
+            write(slot, (slot.usec + wallOffsetUsec) * 1000LL);
+        } else {
+            break;
+        }
+        pending.pop_front();
+    }
+}
+
+void PacketCapture::write(const Slot& slot, long long ns) {
+    bool v6 = destAddr.ss_family == AF_INET6;
+    size_t ipBytes = v6 ? 40 : 20;
+    uint32_t packetBytes = ipBytes + 8 + slot.bytes;
+    if (config.captureMaxSize > 0 && fileBytes + 16 + packetBytes > config.captureMaxSize * 1024L * 1024L) {
+        closePart();
+        openPart();
+    }
+    if (!file) {
+        return;
+    }
+
+    uint32_t record[4] = {
+        static_cast<uint32_t>(ns / 1000000000LL),
+        static_cast<uint32_t>(ns % 1000000000LL),
+        packetBytes,
+        packetBytes,
+    };
+
+    uint8_t headers[48];
+    memset(headers, 0, sizeof(headers));
+    uint16_t udpBytes = 8 + slot.bytes;
+    uint16_t srcPort, destPort;
+    if (v6) {
+        // IPv6 header; the UDP checksum is mandatory here
+        const struct sockaddr_in6* src = (const struct sockaddr_in6*)&srcAddr;
+        const struct sockaddr_in6* dest = (const struct sockaddr_in6*)&destAddr;
+        headers[0] = 0x60;
+        headers[4] = udpBytes >> 8;
+        headers[5] = udpBytes & 0xFF;
+        headers[6] = IPPROTO_UDP;
+        headers[7] = 64;
+        memcpy(headers + 8, &src->sin6_addr, 16);
+        memcpy(headers + 24, &dest->sin6_addr, 16);
+        srcPort = ntohs(src->sin6_port);
+        destPort = ntohs(dest->sin6_port);
+    } else {
+        // IPv4 header (no options, don't fragment); UDP checksum left out
+        const struct sockaddr_in* src = (const struct sockaddr_in*)&srcAddr;
+        const struct sockaddr_in* dest = (const struct sockaddr_in*)&destAddr;
+        headers[0] = 0x45;
+        headers[2] = packetBytes >> 8;
+        headers[3] = packetBytes & 0xFF;
+        headers[4] = (slot.index >> 8) & 0xFF;
+        headers[5] = slot.index & 0xFF;
+        headers[6] = 0x40;
+        headers[8] = 64;
+        headers[9] = IPPROTO_UDP;
+        memcpy(headers + 12, &src->sin_addr, 4);
+        memcpy(headers + 16, &dest->sin_addr, 4);
+        uint16_t checksum = ~checksumAdd(0, headers, 20) & 0xFFFF;
+        headers[10] = checksum >> 8;
+        headers[11] = checksum & 0xFF;
+        srcPort = ntohs(src->sin_port);
+        destPort = ntohs(dest->sin_port);
+    }
+
+    uint8_t* udp = headers + ipBytes;
+    udp[0] = srcPort >> 8;
+    udp[1] = srcPort & 0xFF;
+    udp[2] = destPort >> 8;
+    udp[3] = destPort & 0xFF;
+    udp[4] = udpBytes >> 8;
+    udp[5] = udpBytes & 0xFF;
+    if (v6) {
+        // Pseudo-header (addresses, length, next header), UDP header, payload
+        uint8_t pseudo[8] = {0, 0, (uint8_t)(udpBytes >> 8), (uint8_t)(udpBytes & 0xFF), 0, 0, 0, IPPROTO_UDP};
+        uint32_t sum = checksumAdd(0, headers + 8, 32);
+        sum = checksumAdd(sum, pseudo, 8);
+        sum = checksumAdd(sum, udp, 8);
+        sum = checksumAdd(sum, slot.data, slot.bytes);
+        uint16_t checksum = ~sum & 0xFFFF;
+        if (checksum == 0) {
+            checksum = 0xFFFF;
+        }
+        udp[6] = checksum >> 8;
+        udp[7] = checksum & 0xFF;
+    }
+
+    fwrite(record, sizeof(record), 1, file);
+    fwrite(headers, ipBytes + 8, 1, file);
+    fwrite(slot.data, 1, slot.bytes, file);
+    fileBytes += sizeof(record) + packetBytes;
+    written++;
+}
+
+bool PacketCapture::openPart() {
+    part++;
+    std::string path = basePath + (part > 1 ? "-part" + std::to_string(part) : "") + ".pcap";
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        perror(path.c_str());
+        return false;
+    }
+
+    uint32_t magic = PCAP_MAGIC_NSEC, zone = 0, sigfigs = 0, snaplen = 65535, linkType = LINKTYPE_RAW;
+    uint16_t major = 2, minor = 4;
+    fwrite(&magic, 4, 1, file);
+    fwrite(&major, 2, 1, file);
+    fwrite(&minor, 2, 1, file);
+    fwrite(&zone, 4, 1, file);
+    fwrite(&sigfigs, 4, 1, file);
+    fwrite(&snaplen, 4, 1, file);
+    fwrite(&linkType, 4, 1, file);
+    fileBytes = 24;
+
+    std::cout << "Capturing transmitted packets to " << path << std::endl;
+    pruneCaptures(config);
+    return true;
+}
+
+void PacketCapture::closePart() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+
+#include "clock.h"
+#include "config.h"
+#include "spsc_ring.h"
+
+// Writes every datagram a sender emits to a pcap file (raw IP link type,
+// nanosecond timestamps) that Wireshark opens directly, without running
+// tcpdump as root alongside.
+//
+// Timestamps are the kernel's software TX timestamps, which the sender reads
+// from the socket's error queue and passes on with stamp(), and the sender's
+// own clock after sendto() for datagrams the kernel doesn't stamp. As with
+// AudioCapture, the pacing loop only copies into rings; matching timestamps
+// to datagrams and all file I/O happen on a background thread.
+class PacketCapture {
+public:
+    PacketCapture(const Config& config, const std::string& suffix) : config(config), suffix(suffix) {}
+    ~PacketCapture();
+
+    bool start(time_t when);
+    void stop();
+
+    // Sender: call before the first frame with the connected socket it sends on
+    void attach(int sock, Clock& clock);
+
+    // Called from the pacing loop, never block. index counts datagrams sent
+    // on the socket since attach().
+    bool push(const uint8_t* datagram, size_t bytes, long index, long usec);
+    bool stamp(long index, long long ns);
+
+    long dropped() const { return droppedPackets; }
+    long kernelTimestamped() const { return kernelStamps; }
+
+private:
+    static constexpr size_t RING_SLOTS = 256;
+    static constexpr size_t STAMP_SLOTS = 1024;
+    struct Slot {
+        long index;
+        long usec;            // Sender's clock, monotonic
+        long queuedUsec;      // Writer's real time when taken off the ring
+        uint16_t bytes;
+        uint8_t data[MAX_DATAGRAM];
+    };
+
+    struct Stamp {
+        long index;
+        long long ns;
+    };
+
+    void run();
+    void flush(bool all);
+    void write(const Slot& slot, long long ns);
+    bool openPart();
+    void closePart();
+
+    const Config& config;
+    std::string suffix;
+    std::string basePath;
+
+    SpscRing<Slot, RING_SLOTS> ring;
+    SpscRing<Stamp, STAMP_SLOTS> stampRing;
+    std::atomic<long> droppedPackets{0};
+    std::atomic<long> kernelStamps{0};
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    // Set by attach() before the first push(), read by the writer after it
+    struct sockaddr_storage srcAddr;
+    struct sockaddr_storage destAddr;
+    long wallOffsetUsec = 0;  // Sender clock -> CLOCK_REALTIME, for unstamped datagrams
+
+    // Writer thread only
+    std::deque<Slot> pending;            // Waiting for their kernel timestamp
+    std::map<long, long long> txStamps;  // Datagram index -> kernel TX time, ns since the epoch
+    FILE* file = nullptr;
+    long written = 0;
+    int part = 0;
+    long fileBytes = 0;
+};
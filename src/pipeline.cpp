@@ -0,0 +1,263 @@
+#include <iostream>
+#include <cstdio>
+#include <ctime>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "cache.h"
+#include "dsp.h"
+#include "engines.h"
+#include "pipeline.h"
+#include "tones.h"
+
+// The processed clip played before the speech: the generated chime if one is
+// configured, otherwise preAnnounceFile (or nothing). Held in clipStore(), so
+// after the first announcement it costs no file access until the file changes.
+ClipStore::Clip preAnnounceSegment(const Config& config, const FilterSettings& filter) {
+    ClipStore& store = clipStore();
+    std::vector<int16_t> preAnnounce;
+    
+    if (!config.chime.empty()) {
+        // Levels are set explicitly per tone, so no trimming or normalising
+        std::string chimeKey = "chime|";
+        for (const auto& tone : config.chime) {
+            chimeKey += tone.signature();
+        }
+        chimeKey += "|" + filter.signature();
+        if (ClipStore::Clip clip = store.find(chimeKey)) {
+            return clip;
+        }
+        if (!loadCachedSegment(config, chimeKey, preAnnounce)) {
+            preAnnounce = generateChime(config.chime);
+            applyVoiceFilter(preAnnounce, filter);
+            storeCachedSegment(config, chimeKey, preAnnounce);
+        }
+        ClipStore::Clip clip = std::make_shared<const std::vector<int16_t>>(std::move(preAnnounce));
+        store.store(chimeKey, clip);
+        return clip;
+    }
+    
+    const std::string& file = config.preAnnounceFile;
+    if (file.empty()) {
+        return std::make_shared<const std::vector<int16_t>>();
+    }
+    
+    // Watched files are dropped from memory when they change; otherwise fall
+    // back to keying on the file's size and mtime so edits are picked up. The
+    // on-disk cache is shared with other processes, so it's always keyed on them.
+    std::string preKey = "pre|" + file + "|" + config.dspSignature() + "|" + filter.signature();
+    std::string decodedKey = "decoded|" + file;
+    bool watched = store.watching(file);
+    if (watched) {
+        if (ClipStore::Clip clip = store.find(preKey, file)) {
+            return clip;
+        }
+    }
+    std::string fileVersion;
+    struct stat st;
+    if (stat(file.c_str(), &st) == 0) {
+        fileVersion = "|" + std::to_string(st.st_size) + "|" + std::to_string(st.st_mtime);
+    }
+    std::string diskKey = preKey + fileVersion;
+    if (!watched) {
+        preKey = diskKey;
+        decodedKey += fileVersion;
+        if (ClipStore::Clip clip = store.find(preKey, file)) {
+            return clip;
+        }
+    }
+    
+    if (!loadCachedSegment(config, diskKey, preAnnounce)) {
+        // Destinations with different filters share one decode of the file
+        ClipStore::Clip decoded = store.find(decodedKey, file);
+        if (!decoded) {
+            decoded = std::make_shared<const std::vector<int16_t>>(loadPreAnnounceAudio(file));
+            if (!decoded->empty()) {
+                store.store(decodedKey, decoded, file);
+            }
+        }
+        preAnnounce = *decoded;
+        if (config.trimSilence) {
+            trimSilence(preAnnounce, config.trimThreshold, config.trimHangover);
+        }
+        applyVoiceFilter(preAnnounce, filter);
+        if (config.normalize) {
+            normalizeLoudness(preAnnounce, config.targetLevel, config.limiterCeiling, config.limiterLookahead);
+        }
+        if (!preAnnounce.empty()) {
+            storeCachedSegment(config, diskKey, preAnnounce);
+        }
+    }
+    ClipStore::Clip clip = std::make_shared<const std::vector<int16_t>>(std::move(preAnnounce));
+    if (!clip->empty()) {
+        store.store(preKey, clip, file);
+    }
+    return clip;
+}
+
+// The CW station ID, preceded by a short gap so it doesn't run into the speech.
+// Held in clipStore() like the chime.
+ClipStore::Clip stationIDSegment(const Config& config, const FilterSettings& filter) {
+    std::vector<int16_t> id;
+    char keyBuf[64];
+    snprintf(keyBuf, sizeof(keyBuf), "|%d|%.1f|%.2f|", config.idWpm, config.idFrequency, config.idLevel);
+    std::string key = "cwid|" + config.idCallsign + keyBuf + filter.signature();
+    if (ClipStore::Clip clip = clipStore().find(key)) {
+        return clip;
+    }
+    if (!loadCachedSegment(config, key, id)) {
+        id.resize(SAMPLE_RATE / 4, 0);
+        std::vector<int16_t> morse = generateMorse(config.idCallsign, config.idWpm,
+                                                   config.idFrequency, config.idLevel);
+        id.insert(id.end(), morse.begin(), morse.end());
+        applyVoiceFilter(id, filter);
+        storeCachedSegment(config, key, id);
+        std::cout << "Generated CW ID \"" << config.idCallsign << "\": "
+                  << (float)id.size() / SAMPLE_RATE << " seconds" << std::endl;
+    }
+    ClipStore::Clip clip = std::make_shared<const std::vector<int16_t>>(std::move(id));
+    clipStore().store(key, clip);
+    return clip;
+}
+
+// Whether this announcement should carry the CW ID, based on when the last one
+// was sent (recorded in idStateFile so it works across cron-started runs)
+bool stationIDDue(const Config& config, time_t now) {
+    if (!config.idEnabled || config.idCallsign.empty()) {
+        return false;
+    }
+    if (config.idInterval <= 0) {
+        return true;
+    }
+
+    long last = 0;
+    FILE* f = fopen(config.idStateFile.c_str(), "r");
+    if (f) {
+        if (fscanf(f, "%ld", &last) != 1) {
+            last = 0;
+        }
+        fclose(f);
+    }
+    // A minute of slack so an hourly job that starts a little early still IDs
+    return now - last >= config.idInterval * 60L - 60;
+}
+
+void recordStationID(const Config& config, time_t now) {
+    FILE* f = fopen(config.idStateFile.c_str(), "w");
+    if (!f) {
+        std::cerr << "Failed to write " << config.idStateFile << std::endl;
+        return;
+    }
+    fprintf(f, "%ld\n", (long)now);
+    fclose(f);
+}
+
+std::vector<int16_t> generateTTSAudio(const std::string& text, const Config& config,
+                                      const FilterSettings& filter, const FramingProfile& framing,
+                                      bool withStationID) {
+    std::vector<int16_t> samples;
+    
+    // Add lead silence, rounded up to a whole number of the protocol's voice
+    // units (P25: 9 IMBE frames of 160 samples = 1440 samples per LDU)
+    const int unitSamples = framing.unitSamples;
+    int leadSamples = static_cast<int>(SAMPLE_RATE * config.leadSilence);
+    leadSamples = ((leadSamples + unitSamples - 1) / unitSamples) * unitSamples;
+    samples.resize(leadSamples, 0);
+    
+    // Add pre-announce audio if configured
+    ClipStore::Clip preAnnounce = preAnnounceSegment(config, filter);
+    samples.insert(samples.end(), preAnnounce->begin(), preAnnounce->end());
+    
+    // CW ID goes after the speech, but it counts against the airtime budget
+    ClipStore::Clip stationID = std::make_shared<const std::vector<int16_t>>();
+    if (withStationID) {
+        stationID = stationIDSegment(config, filter);
+    }
+    
+    // Speech: synthesize, trim, fit to airtime, filter, normalise - or reuse the cached result.
+    // The airtime budget depends on everything around the speech, so it's part of the key.
+    int trailSamples = static_cast<int>(SAMPLE_RATE * config.trailSilence);
+    size_t around = samples.size() + stationID->size() + trailSamples;
+    std::string speechKey = speechCacheKey(text, config) + "|" + filter.signature() + "|" +
+                            std::to_string(around);
+    std::vector<int16_t> speech;
+    if (!loadCachedSegment(config, speechKey, speech)) {
+        // Nothing to send without the speech; lead silence alone isn't an announcement
+        if (!synthesizeSpeech(text, config, speech)) {
+            return std::vector<int16_t>();
+        }
+        
+        // Engines pad their output with near-silence; strip it so we don't
+        // transmit it on top of the configured lead/trail silence
+        if (config.trimSilence) {
+            trimSilence(speech, config.trimThreshold, config.trimHangover);
+        }
+        
+        // Fit the announcement into the airtime budget (measured before framing padding)
+        // by speeding up the speech only - silence and pre-announce are left alone
+        if (config.maxAirtime > 0 && !speech.empty()) {
+            double budget = config.maxAirtime * SAMPLE_RATE - around;
+            if (budget <= 0) {
+                std::cerr << "Warning: audio around the speech alone exceeds maxAirtime, not compressing" << std::endl;
+            } else if (speech.size() > budget) {
+                double tempo = speech.size() / budget;
+                if (tempo > config.maxSpeedup) {
+                    std::cerr << "Warning: would need " << tempo << "x to fit maxAirtime, limiting to "
+                              << config.maxSpeedup << "x" << std::endl;
+                    tempo = config.maxSpeedup;
+                }
+                size_t before = speech.size();
+                speech = timeCompress(speech, tempo);
+                std::cout << "Time-compressed speech " << tempo << "x: " << before << " -> "
+                          << speech.size() << " samples" << std::endl;
+            }
+        }
+        
+        // Filter before normalising, so the limiter sees the final waveform
+        applyVoiceFilter(speech, filter);
+        if (config.normalize) {
+            normalizeLoudness(speech, config.targetLevel, config.limiterCeiling, config.limiterLookahead);
+        }
+        if (!speech.empty()) {
+            storeCachedSegment(config, speechKey, speech);
+        }
+    }
+    samples.insert(samples.end(), speech.begin(), speech.end());
+    samples.insert(samples.end(), stationID->begin(), stationID->end());
+    
+    // Add trail silence
+    samples.resize(samples.size() + trailSamples, 0);
+    
+    // Pad to a whole number of voice units
+    padToBoundary(samples, unitSamples);
+    
+    std::cout << "Generated " << samples.size() << " samples ("
+              << leadSamples << " lead silence + audio + "
+              << trailSamples << " trail silence + padding to whole " << framing.name << " "
+              << framing.unit << "s)" << std::endl;
+    return samples;
+}
+
+std::string getTimeAnnouncement(const Config& config, Clock& clock) {
+    time_t now = clock.now();
+    struct tm local;
+    struct tm* t = localtime_r(&now, &local);
+    
+    char buf[256];
+    
+    if (config.use12Hour) {
+        int hour = t->tm_hour % 12;
+        if (hour == 0) hour = 12;
+        
+        if (config.includeAMPM) {
+            const char* ampm = (t->tm_hour >= 12) ? "P M" : "A M";
+            snprintf(buf, sizeof(buf), "%s %d o'clock %s", config.prefix.c_str(), hour, ampm);
+        } else {
+            snprintf(buf, sizeof(buf), "%s %d o'clock", config.prefix.c_str(), hour);
+        }
+    } else {
+        snprintf(buf, sizeof(buf), "%s %02d hundred hours", config.prefix.c_str(), t->tm_hour);
+    }
+    
+    return std::string(buf);
+}
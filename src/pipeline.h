@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "clock.h"
+#include "config.h"
+
+ClipStore::Clip preAnnounceSegment(const Config& config, const FilterSettings& filter);
+ClipStore::Clip stationIDSegment(const Config& config, const FilterSettings& filter);
+bool stationIDDue(const Config& config, time_t now);
+void recordStationID(const Config& config, time_t now);
+std::vector<int16_t> generateTTSAudio(const std::string& text, const Config& config,
+                                      const FilterSettings& filter, const FramingProfile& framing,
+                                      bool withStationID);
+std::string getTimeAnnouncement(const Config& config, Clock& clock = systemClock());
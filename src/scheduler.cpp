@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <iostream>
+#include <time.h>
+
+#include "scheduler.h"
+
+time_t nextAnnouncementTime(time_t now, int intervalMinutes) {
+    long step = (intervalMinutes > 0 ? intervalMinutes : 60) * 60L;
+    
+    // Align to local time, not UTC, so half-hour timezones still announce on the hour
+    struct tm local;
+    localtime_r(&now, &local);
+    long offset = local.tm_gmtoff;
+    
+    long localNow = now + offset;
+    time_t next = (localNow / step + 1) * step - offset;
+    
+    // A DST change between now and then moves the local boundary by the difference
+    struct tm then;
+    localtime_r(&next, &then);
+    if (then.tm_gmtoff != offset) {
+        next -= then.tm_gmtoff - offset;
+        if (next <= now) {
+            next += step;
+        }
+    }
+    return next;
+}
+
+int runScheduler(Clock& clock, int intervalMinutes, const std::function<bool(time_t)>& announce,
+                 time_t until) {
+    int count = 0;
+    time_t slot = nextAnnouncementTime(clock.now(), intervalMinutes);
+    
+    while (until == 0 || slot <= until) {
+        // Sleep in steps of at most a minute, so wall-clock adjustments are noticed
+        time_t now = clock.now();
+        if (now < slot) {
+            clock.sleepUsec(std::min<long>(slot - now, 60) * 1000000L);
+            continue;
+        }
+        
+        if (now - slot > 60) {
+            std::cerr << "Warning: woke " << (now - slot) << " seconds late, skipping announcement" << std::endl;
+        } else {
+            count++;
+            if (!announce(slot)) {
+                break;
+            }
+        }
+        slot = nextAnnouncementTime(clock.now(), intervalMinutes);
+    }
+    return count;
+}
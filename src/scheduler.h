@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ctime>
+#include <functional>
+
+#include "clock.h"
+
+// First local-time boundary of intervalMinutes strictly after now (on the hour
+// for 60, quarter past/half past/... for 15)
+time_t nextAnnouncementTime(time_t now, int intervalMinutes);
+
+// Sleep until each boundary and call announce(slot) for it, until a callback
+// returns false or the next slot would be after `until` (0 = run forever).
+// Returns the number of announcements made.
+int runScheduler(Clock& clock, int intervalMinutes, const std::function<bool(time_t)>& announce,
+                 time_t until = 0);
@@ -0,0 +1,252 @@
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <random>
+
+#include "config.h"
+#include "g711.h"
+#include "sender.h"
+#include "txstamp.h"
+
+// Build packet: 4-byte big-endian length + PCM data, zero padding a short final frame
+void buildFrame(uint8_t* packet, const uint8_t* pcm, size_t chunkSize) {
+    // Length header (big-endian)
+    uint32_t len = FRAME_SIZE;
+    packet[0] = (len >> 24) & 0xFF;
+    packet[1] = (len >> 16) & 0xFF;
+    packet[2] = (len >> 8) & 0xFF;
+    packet[3] = len & 0xFF;
+    
+    memcpy(packet + 4, pcm, chunkSize);
+    if (chunkSize < FRAME_SIZE) {
+        memset(packet + 4 + chunkSize, 0, FRAME_SIZE - chunkSize);
+    }
+}
+
+std::string wireDescription(const WireFormat& wire) {
+    if (wire.encoding == WIRE_PCM && !wire.rtp) {
+        return "";
+    }
+    return std::string(" as ") + wire.encodingName() + (wire.rtp ? " over RTP" : "");
+}
+
+FrameEncoder::FrameEncoder(const WireFormat& format) : format(format) {
+    std::random_device random;
+    sequence = static_cast<uint16_t>(random());
+    timestamp = random();
+    ssrc = random();
+}
+
+size_t FrameEncoder::encode(const uint8_t* pcm, uint8_t* datagram) {
+    const int16_t* samples = reinterpret_cast<const int16_t*>(pcm);
+    const size_t count = FRAME_SIZE / sizeof(int16_t);
+    if (!format.rtp) {
+        if (format.encoding == WIRE_PCM) {
+            buildFrame(datagram, pcm, FRAME_SIZE);
+            return 4 + FRAME_SIZE;
+        }
+        // Same 4-byte big-endian length header, over 160 bytes of G.711
+        datagram[0] = datagram[1] = datagram[2] = 0;
+        datagram[3] = count;
+        if (format.encoding == WIRE_ULAW) {
+            encodeULaw(samples, datagram + 4, count);
+        } else {
+            encodeALaw(samples, datagram + 4, count);
+        }
+        return 4 + count;
+    }
+
+    // RTP header: version 2, marker on the first packet of the talkspurt
+    uint8_t payloadType = format.encoding == WIRE_ULAW ? 0 : format.encoding == WIRE_ALAW ? 8 : 96;
+    datagram[0] = 0x80;
+    datagram[1] = (first ? 0x80 : 0) | payloadType;
+    datagram[2] = sequence >> 8;
+    datagram[3] = sequence & 0xFF;
+    for (int i = 0; i < 4; i++) {
+        datagram[4 + i] = (timestamp >> (24 - 8 * i)) & 0xFF;
+        datagram[8 + i] = (ssrc >> (24 - 8 * i)) & 0xFF;
+    }
+    first = false;
+    sequence++;
+    timestamp += count;
+
+    uint8_t* payload = datagram + 12;
+    if (format.encoding == WIRE_ULAW) {
+        encodeULaw(samples, payload, count);
+        return 12 + count;
+    }
+    if (format.encoding == WIRE_ALAW) {
+        encodeALaw(samples, payload, count);
+        return 12 + count;
+    }
+    // L16 is big-endian on the wire
+    for (size_t i = 0; i < count; i++) {
+        payload[2 * i] = static_cast<uint16_t>(samples[i]) >> 8;
+        payload[2 * i + 1] = samples[i] & 0xFF;
+    }
+    return 12 + FRAME_SIZE;
+}
+
+// Frame k is due k * 20ms into the transmission, as measured by the bridge's
+// clock: scaling our timeline keeps the frame rate matched to the rate the
+// bridge consumes them, so its buffer neither drains nor fills however long
+// we transmit
+//
+// A pre-roll sends the first frames of lead silence as one burst to fill the
+// bridge's jitter buffer straight away; everything after is due that many
+// frames earlier
+FrameSchedule::FrameSchedule(const std::vector<int16_t>& samples, const SendOptions& options) {
+    size_t totalBytes = samples.size() * sizeof(int16_t);
+    frames = static_cast<long>((totalBytes + FRAME_SIZE - 1) / FRAME_SIZE);
+    if (options.prerollFrames > 0) {
+        size_t silent = 0;
+        while (silent < samples.size() && samples[silent] == 0) {
+            silent++;
+        }
+        long silentFrames = static_cast<long>(silent * sizeof(int16_t) / FRAME_SIZE);
+        long fullFrames = static_cast<long>(totalBytes / FRAME_SIZE);
+        preroll = std::min<long>(options.prerollFrames, std::max(0L, std::min(silentFrames, fullFrames) - 1));
+    }
+    frameUsec = 20000.0 * 1e6 / (1e6 + options.driftPpm);
+}
+
+void deliverTxStamps(std::vector<TxStamp>& stamps, const SendOptions& options) {
+    for (const TxStamp& stamp : stamps) {
+        if (options.stats) {
+            options.stats->stamp(stamp);
+        }
+        if (options.pcap && stamp.type == TX_SOFTWARE) {
+            options.pcap->stamp(stamp.index, stamp.ns);
+        }
+    }
+    stamps.clear();
+}
+
+bool sendAudioToDVMBridge(const std::vector<int16_t>& samples, const std::string& host, int port,
+                          const SendOptions& options) {
+    UdpTransport transport(host, port);
+    return sendAudioToDVMBridge(samples, transport, options);
+}
+
+bool sendAudioToDVMBridge(const std::vector<int16_t>& samples, Transport& transport,
+                          const SendOptions& options) {
+    Clock& clock = *options.clock;
+    AudioCapture* capture = options.capture;
+    PacketCapture* pcap = options.pcap;
+    PacingStats* stats = options.stats;
+
+    if (!transport.open(clock)) {
+        return false;
+    }
+    int sock = transport.fd();
+    if (sock < 0) {
+        // Not going through the network stack: no datagrams to capture or stamp
+        pcap = nullptr;
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(samples.data());
+    size_t totalBytes = samples.size() * sizeof(int16_t);
+    size_t offset = 0;
+    int frameCount = 0;
+
+    std::cout << "Sending " << totalBytes << " bytes (" 
+              << (totalBytes / FRAME_SIZE) << " frames) to " 
+              << transport.name() << wireDescription(options.wire) << std::endl;
+
+    // Kernel TX timestamps, collected without blocking as the frames go out
+    bool timestamps = sock >= 0 && (pcap || stats) && enableTxTimestamps(sock, options.hardwareTimestamps);
+    std::vector<TxStamp> stamps;
+    stamps.reserve(64);
+
+    if (pcap) {
+        pcap->attach(sock, clock);
+    }
+
+    FrameSchedule schedule(samples, options);
+    FrameEncoder encoder(options.wire);
+
+    // Get start time for precise pacing
+    long startUsec = clock.monotonicUsec();
+    if (stats) {
+        stats->begin(schedule.frames, startUsec);
+    }
+
+    bool ok = true;
+    while (offset < totalBytes) {
+        size_t chunkSize = std::min((size_t)FRAME_SIZE, totalBytes - offset);
+        
+        // One whole frame of PCM, the last zero padded, in the wire format
+        uint8_t frame[FRAME_SIZE];
+        memcpy(frame, data + offset, chunkSize);
+        memset(frame + chunkSize, 0, FRAME_SIZE - chunkSize);
+        uint8_t packet[MAX_DATAGRAM];
+        size_t packetBytes = encoder.encode(frame, packet);
+
+        long callUsec = stats ? clock.monotonicUsec() : 0;
+        ssize_t sent = transport.send(packet, packetBytes);
+        if (sent < 0) {
+            // ICMP port unreachable for an earlier frame: no bridge is listening
+            if (errno == ECONNREFUSED) {
+                std::cerr << "Nothing listening at " << transport.name() << ", aborting after "
+                          << frameCount << " frames" << std::endl;
+            } else {
+                perror("send");
+            }
+            ok = false;
+            break;
+        }
+
+        long sentUsec = clock.monotonicUsec();
+        if (capture) {
+            capture->push(frame, FRAME_SIZE, sentUsec);
+        }
+        if (pcap) {
+            pcap->push(packet, packetBytes, frameCount, sentUsec);
+        }
+        if (stats) {
+            stats->sent(frameCount, schedule.dueUsec(frameCount), callUsec, sentUsec);
+        }
+        if (timestamps) {
+            readTxTimestamps(sock, stamps);
+            deliverTxStamps(stamps, options);
+        }
+
+        offset += FRAME_SIZE;
+        frameCount++;
+        
+        // Calculate when the next frame should be sent
+        long targetUsec = schedule.dueUsec(frameCount);
+        
+        // Get current elapsed time
+        long elapsedUsec = sentUsec - startUsec;
+        
+        // Sleep for the remaining time until next frame
+        long sleepUsec = targetUsec - elapsedUsec;
+        if (sleepUsec > 0) {
+            clock.sleepUsec(sleepUsec);
+        }
+    }
+
+    // Stamps for the last frames may still be on their way
+    if (timestamps) {
+        awaitTxTimestamps(sock, stamps, 50);
+        deliverTxStamps(stamps, options);
+        disableTxTimestamps(sock);
+    }
+
+    if (transport.dropped()) {
+        std::cerr << "Warning: " << transport.name() << " fell behind, " << transport.dropped()
+                  << " frames dropped" << std::endl;
+    }
+    if (!ok) {
+        return false;
+    }
+    std::cout << "Done sending audio" << std::endl;
+    if (schedule.preroll > 0) {
+        std::cout << "Pre-roll: " << schedule.preroll + 1 << " frames in the opening burst, audio reached "
+                  << transport.name() << " " << schedule.preroll * 20 << " ms sooner" << std::endl;
+    }
+    return true;
+}
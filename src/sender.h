@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+#include "clock.h"
+#include "pacing_stats.h"
+#include "pcap.h"
+#include "transport.h"
+#include "txstamp.h"
+
+void buildFrame(uint8_t* packet, const uint8_t* pcm, size_t chunkSize);
+
+// " as ulaw over RTP" etc. for log output; empty for the default format
+std::string wireDescription(const WireFormat& wire);
+
+// Turns 20ms frames of PCM into datagrams in a destination's wire format. Use
+// one per transmission: RTP sequence numbers and timestamps run on from one
+// frame to the next, starting from random values.
+class FrameEncoder {
+public:
+    explicit FrameEncoder(const WireFormat& format);
+
+    // pcm is one whole frame, FRAME_SIZE bytes; datagram has room for
+    // MAX_DATAGRAM. Returns the datagram's size.
+    size_t encode(const uint8_t* pcm, uint8_t* datagram);
+
+private:
+    WireFormat format;
+    uint16_t sequence;
+    uint32_t timestamp;
+    uint32_t ssrc;
+    bool first = true;
+};
+// Optional extras for a transmission; the defaults are a plain paced send on the system clock
+struct SendOptions {
+    Clock* clock = &systemClock();
+    AudioCapture* capture = nullptr;  // Record the frames as sent
+    PacketCapture* pcap = nullptr;    // Record the datagrams as sent
+    PacingStats* stats = nullptr;     // Break down per-frame pacing delays
+    bool hardwareTimestamps = false;  // Ask for NIC TX timestamps as well as software ones
+    double driftPpm = 0;              // How much faster the bridge's clock runs than ours
+    int prerollFrames = 0;            // Leading silent frames to send at once, ahead of real time
+    WireFormat wire;                  // Payload encoding and framing of each datagram
+};
+
+// When each frame of a transmission is due, relative to its start
+struct FrameSchedule {
+    FrameSchedule(const std::vector<int16_t>& samples, const SendOptions& options);
+
+    long dueUsec(long frame) const {
+        return static_cast<long>(std::max(0L, frame - preroll) * frameUsec + 0.5);
+    }
+
+    long frames;        // Datagrams in the transmission, the last zero padded
+    long preroll = 0;   // Frames sent in the opening burst after the first
+    double frameUsec;   // 20ms on the bridge's clock
+};
+
+// Hand kernel TX timestamps on to the options' stats and pcap, then clear them
+void deliverTxStamps(std::vector<TxStamp>& stamps, const SendOptions& options);
+
+// Paced transmission of samples; false if it could not be sent or was cut
+// short because nothing is listening
+bool sendAudioToDVMBridge(const std::vector<int16_t>& samples, Transport& transport,
+                          const SendOptions& options = SendOptions());
+
+// One destination's part in an announcement sent to several at once
+struct Transmission {
+    const std::vector<int16_t>* samples = nullptr;
+    Transport* transport = nullptr;
+    SendOptions options;
+    bool ok = false;  // Set once sent: every frame went out
+};
+
+// One-off transmission over UDP on a temporary transport
+bool sendAudioToDVMBridge(const std::vector<int16_t>& samples, const std::string& host, int port,
+                          const SendOptions& options = SendOptions());
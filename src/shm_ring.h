@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Shared-memory frame ring between time-announce and a bridge on the same
+// host. The sender creates the memory (a memfd) and an eventfd doorbell, and
+// hands both to the consumer over a unix seqpacket socket with SCM_RIGHTS,
+// along with SHM_RING_MAGIC as the message. Each slot holds one datagram
+// exactly as it would have gone over UDP, and the time it was published.
+//
+// The consumer sets consumerWaiting before sleeping on the eventfd and checks
+// the ring once more; the producer rings the doorbell only if it finds the
+// flag set after publishing, so a consumer that is keeping up costs the
+// producer no system calls at all.
+constexpr uint32_t SHM_RING_MAGIC = 0x54415246;  // "TARF"
+constexpr uint32_t SHM_RING_VERSION = 1;
+constexpr uint32_t SHM_RING_SLOTS = 256;         // ~5 seconds of frames
+constexpr uint32_t SHM_SLOT_BYTES = 1024;
+
+struct ShmSlot {
+    uint32_t bytes;
+    uint32_t reserved;
+    int64_t usec;  // CLOCK_REALTIME when published
+    uint8_t data[SHM_SLOT_BYTES];
+};
+
+struct ShmRing {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slotBytes;
+
+    alignas(64) std::atomic<uint64_t> head;  // Next slot the consumer reads
+    std::atomic<uint32_t> consumerWaiting;   // Consumer is asleep, or about to be
+    alignas(64) std::atomic<uint64_t> tail;  // Next slot the producer fills
+
+    alignas(64) ShmSlot ring[SHM_RING_SLOTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs address-free atomics");
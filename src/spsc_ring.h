@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Fixed-size single-producer/single-consumer ring. The producer claims a slot,
+// fills it in place and publishes it; the consumer reads the front slot and
+// pops it. Neither side ever blocks or allocates after construction.
+template <typename T, size_t N>
+class SpscRing {
+public:
+    SpscRing() : slots(N) {}
+
+    // Producer: next free slot, or nullptr when the ring is full
+    T* claim() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) {
+            return nullptr;
+        }
+        return &slots[t % N];
+    }
+
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: oldest published slot, or nullptr when the ring is empty
+    T* front() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[h % N];
+    }
+
+    void pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> slots;
+    std::atomic<size_t> head{0};  // Next slot the consumer reads
+    std::atomic<size_t> tail{0};  // Next slot the producer fills
+};
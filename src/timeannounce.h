@@ -0,0 +1,23 @@
+#pragma once
+
+// Everything the time-announce front end, the benchmarks and other tools
+// embedding the announcement pipeline need
+
+#include "clock.h"
+#include "config.h"
+#include "dsp.h"
+#include "g711.h"
+#include "tones.h"
+#include "cache.h"
+#include "engines.h"
+#include "pipeline.h"
+#include "txstamp.h"
+#include "pacing_stats.h"
+#include "transport.h"
+#include "sender.h"
+#include "uring_sender.h"
+#include "capture.h"
+#include "channel_monitor.h"
+#include "pcap.h"
+#include "scheduler.h"
+#include "announce.h"
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "tones.h"
+
+// Append a tone step to `out`. Each frequency runs its own recursive
+// oscillator (y[n] = 2cos(w)y[n-1] - y[n-2]), so there are no sin() calls
+// per sample; attack and release are raised-cosine ramps.
+void renderTone(const ToneSpec& tone, std::vector<int16_t>& out) {
+    size_t n = static_cast<size_t>(tone.duration) * SAMPLE_RATE / 1000;
+    if (tone.freqs.empty()) {
+        out.resize(out.size() + n, 0);
+        return;
+    }
+
+    std::vector<float> mix(n, 0.0f);
+    // Split the level between the tones so their sum can't exceed it
+    double amplitude = pow(10.0, tone.level / 20.0) * 32767.0 / tone.freqs.size();
+    for (float freq : tone.freqs) {
+        double w = 2.0 * M_PI * freq / SAMPLE_RATE;
+        double k = 2.0 * cos(w);
+        double y1 = -sin(w), y2 = -sin(2.0 * w);  // y[-1], y[-2] of sin(w*n)
+        for (size_t i = 0; i < n; i++) {
+            double y = k * y1 - y2;
+            y2 = y1;
+            y1 = y;
+            mix[i] += static_cast<float>(y * amplitude);
+        }
+    }
+
+    size_t attack = std::min(n, static_cast<size_t>(tone.attack) * SAMPLE_RATE / 1000);
+    size_t release = std::min(n, static_cast<size_t>(tone.release) * SAMPLE_RATE / 1000);
+    for (size_t i = 0; i < attack; i++) {
+        mix[i] *= 0.5f - 0.5f * cosf(static_cast<float>(M_PI) * i / attack);
+    }
+    for (size_t i = 0; i < release; i++) {
+        mix[n - 1 - i] *= 0.5f - 0.5f * cosf(static_cast<float>(M_PI) * i / release);
+    }
+
+    size_t base = out.size();
+    out.resize(base + n);
+    for (size_t i = 0; i < n; i++) {
+        float v = std::max(-32768.0f, std::min(32767.0f, mix[i]));
+        out[base + i] = static_cast<int16_t>(std::lrint(v));
+    }
+}
+
+std::vector<int16_t> generateChime(const std::vector<ToneSpec>& chime) {
+    std::vector<int16_t> samples;
+    for (const auto& tone : chime) {
+        renderTone(tone, samples);
+    }
+    std::cout << "Generated chime: " << samples.size() << " samples ("
+              << (float)samples.size() / SAMPLE_RATE << " seconds)" << std::endl;
+    return samples;
+}
+
+const char* morseCode(char c) {
+    static const char* letters[] = {
+        ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---", "-.-", ".-..", "--",
+        "-.", "---", ".--.", "--.-", ".-.", "...", "-", "..-", "...-", ".--", "-..-", "-.--", "--.."
+    };
+    static const char* digits[] = {
+        "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----."
+    };
+    if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    if (c >= 'A' && c <= 'Z') return letters[c - 'A'];
+    if (c >= '0' && c <= '9') return digits[c - '0'];
+    switch (c) {
+        case '/': return "-..-.";
+        case '?': return "..--..";
+        case '.': return ".-.-.-";
+        case ',': return "--..--";
+        case '-': return "-....-";
+        case '=': return "-...-";
+        default:  return nullptr;
+    }
+}
+
+// Render `text` as Morse at the given speed (PARIS timing: one unit is
+// 1.2/wpm seconds). Elements are keyed with 5ms raised-cosine edges so the
+// ID doesn't splatter key clicks through the vocoder.
+std::vector<int16_t> generateMorse(const std::string& text, int wpm, float frequency, float level) {
+    std::vector<int16_t> samples;
+    const int unit = 1200 / std::max(wpm, 1);  // ms
+    ToneSpec mark;
+    mark.freqs = {frequency};
+    mark.level = level;
+    mark.attack = mark.release = 5;
+    ToneSpec space;
+
+    bool first = true;
+    for (char c : text) {
+        if (c == ' ') {
+            // Word gap is 7 units; the letter gap before it already gave 3
+            space.duration = 4 * unit;
+            renderTone(space, samples);
+            continue;
+        }
+        const char* code = morseCode(c);
+        if (!code) {
+            continue;
+        }
+        if (!first) {
+            space.duration = 3 * unit;
+            renderTone(space, samples);
+        }
+        first = false;
+        for (const char* e = code; *e; e++) {
+            if (e != code) {
+                space.duration = unit;
+                renderTone(space, samples);
+            }
+            mark.duration = (*e == '-') ? 3 * unit : unit;
+            renderTone(mark, samples);
+        }
+    }
+    return samples;
+}
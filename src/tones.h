@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+void renderTone(const ToneSpec& tone, std::vector<int16_t>& out);
+std::vector<int16_t> generateChime(const std::vector<ToneSpec>& chime);
+const char* morseCode(char c);
+std::vector<int16_t> generateMorse(const std::string& text, int wpm, float frequency, float level);
@@ -0,0 +1,285 @@
+#include <iostream>
+#include <cstring>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "transport.h"
+
+UdpTransport::~UdpTransport() {
+    close();
+}
+
+void UdpTransport::close() {
+    if (sock >= 0) {
+        ::close(sock);
+        sock = -1;
+    }
+}
+
+bool UdpTransport::resolve(struct sockaddr_storage& addr, socklen_t& addrLen) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+
+    struct addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    int err = getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+    if (err != 0) {
+        std::cerr << "Cannot resolve " << host << ": " << gai_strerror(err) << std::endl;
+        return false;
+    }
+    // getaddrinfo has already sorted the candidates by preference
+    memcpy(&addr, result->ai_addr, result->ai_addrlen);
+    addrLen = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+// Hop limit, outgoing interface and loopback for a multicast peer; nothing
+// to do for unicast
+bool UdpTransport::setupMulticast() {
+    bool v6 = peer.ss_family == AF_INET6;
+    if (v6 ? !IN6_IS_ADDR_MULTICAST(&((struct sockaddr_in6*)&peer)->sin6_addr)
+           : !IN_MULTICAST(ntohl(((struct sockaddr_in*)&peer)->sin_addr.s_addr))) {
+        return true;
+    }
+
+    int ttl = multicast.ttl;
+    int loop = multicast.loop;
+    bool ok = v6 ? setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl)) == 0 &&
+                   setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof(loop)) == 0
+                 : setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0 &&
+                   setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) == 0;
+    if (!ok) {
+        perror(("multicast ttl/loop for " + host).c_str());
+        return false;
+    }
+    if (multicast.interface.empty()) {
+        return true;
+    }
+
+    struct ip_mreqn mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    unsigned index = 0;
+    if (v6 || inet_pton(AF_INET, multicast.interface.c_str(), &mreq.imr_address) != 1) {
+        index = if_nametoindex(multicast.interface.c_str());
+        if (index == 0) {
+            perror(("multicast interface " + multicast.interface + " for " + host).c_str());
+            return false;
+        }
+    }
+    mreq.imr_ifindex = index;
+    ok = v6 ? setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index)) == 0
+            : setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof(mreq)) == 0;
+    if (!ok) {
+        perror(("multicast interface " + multicast.interface + " for " + host).c_str());
+        return false;
+    }
+    return true;
+}
+
+bool UdpTransport::open(Clock& clock) {
+    time_t now = clock.now();
+    if (sock < 0 || now - resolvedAt >= resolveInterval) {
+        struct sockaddr_storage addr;
+        socklen_t addrLen = 0;
+        if (!resolve(addr, addrLen)) {
+            if (sock < 0) {
+                return false;
+            }
+            std::cerr << "Keeping the previous address for " << host << std::endl;
+        } else {
+            resolvedAt = now;
+            if (sock >= 0 && (addrLen != peerLen || memcmp(&addr, &peer, addrLen) != 0)) {
+                std::cout << host << " has moved, reconnecting" << std::endl;
+                close();
+            }
+            peer = addr;
+            peerLen = addrLen;
+        }
+    }
+
+    if (sock < 0) {
+        sock = socket(peer.ss_family, SOCK_DGRAM, 0);
+        if (sock < 0) {
+            perror("socket");
+            return false;
+        }
+        // setupMulticast() reports its own failures
+        if (!setupMulticast()) {
+            close();
+            return false;
+        }
+        if (connect(sock, (struct sockaddr*)&peer, peerLen) < 0) {
+            perror(("connect " + host).c_str());
+            close();
+            return false;
+        }
+
+        char address[INET6_ADDRSTRLEN] = "";
+        const void* raw = peer.ss_family == AF_INET6
+            ? (const void*)&((struct sockaddr_in6*)&peer)->sin6_addr
+            : (const void*)&((struct sockaddr_in*)&peer)->sin_addr;
+        inet_ntop(peer.ss_family, raw, address, sizeof(address));
+        description = host + (host == address ? "" : std::string("[") + address + "]") + ":" + std::to_string(port);
+    }
+
+    // A refusal from the previous transmission's last frames is stale by now
+    int pending = 0;
+    socklen_t len = sizeof(pending);
+    getsockopt(sock, SOL_SOCKET, SO_ERROR, &pending, &len);
+    return true;
+}
+
+ShmTransport::~ShmTransport() {
+    close();
+}
+
+void ShmTransport::close() {
+    if (ring) {
+        munmap(ring, sizeof(ShmRing));
+        ring = nullptr;
+    }
+    if (doorbell >= 0) {
+        ::close(doorbell);
+        doorbell = -1;
+    }
+    if (control >= 0) {
+        ::close(control);
+        control = -1;
+    }
+}
+
+// The consumer closing its end is the only thing it ever does on the socket
+bool ShmTransport::consumerGone() const {
+    char byte;
+    return recv(control, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+bool ShmTransport::open(Clock&) {
+    droppedFrames = 0;
+    if (control >= 0 && !consumerGone()) {
+        return true;
+    }
+    if (control >= 0) {
+        std::cout << description << ": consumer went away, reconnecting" << std::endl;
+        close();
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return false;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    control = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (control < 0) {
+        perror("socket");
+        return false;
+    }
+    if (connect(control, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror(("connect " + path).c_str());
+        close();
+        return false;
+    }
+
+    int memory = memfd_create("time-announce-ring", MFD_CLOEXEC);
+    if (memory < 0 || ftruncate(memory, sizeof(ShmRing)) < 0) {
+        perror("memfd_create");
+        if (memory >= 0) {
+            ::close(memory);
+        }
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+    doorbell = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (mapped == MAP_FAILED || doorbell < 0) {
+        perror("shared ring");
+        if (mapped != MAP_FAILED) {
+            munmap(mapped, sizeof(ShmRing));
+        }
+        ::close(memory);
+        close();
+        return false;
+    }
+    ring = static_cast<ShmRing*>(mapped);  // A fresh memfd is zero filled
+    ring->magic = SHM_RING_MAGIC;
+    ring->version = SHM_RING_VERSION;
+    ring->slots = SHM_RING_SLOTS;
+    ring->slotBytes = SHM_SLOT_BYTES;
+
+    // Hand the consumer the ring and the doorbell
+    uint32_t magic = SHM_RING_MAGIC;
+    struct iovec iov = {&magic, sizeof(magic)};
+    char cmsgBuf[CMSG_SPACE(2 * sizeof(int))];
+    memset(cmsgBuf, 0, sizeof(cmsgBuf));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsgBuf;
+    msg.msg_controllen = sizeof(cmsgBuf);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    int fds[2] = {memory, doorbell};
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    bool sent = sendmsg(control, &msg, MSG_NOSIGNAL) == sizeof(magic);
+    if (!sent) {
+        perror(("sendmsg " + path).c_str());
+    }
+    ::close(memory);  // The mapping and the consumer's copy keep it alive
+    if (!sent) {
+        close();
+        return false;
+    }
+    std::cout << "Connected to " << description << std::endl;
+    return true;
+}
+
+ssize_t ShmTransport::send(const uint8_t* data, size_t bytes) {
+    if (!ring || bytes > SHM_SLOT_BYTES) {
+        errno = ring ? EMSGSIZE : ENOTCONN;
+        return -1;
+    }
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->head.load(std::memory_order_acquire) == SHM_RING_SLOTS) {
+        if (consumerGone()) {
+            errno = ECONNREFUSED;
+            return -1;
+        }
+        droppedFrames++;
+        return bytes;
+    }
+
+    ShmSlot& slot = ring->ring[tail % SHM_RING_SLOTS];
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    slot.usec = now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+    slot.bytes = bytes;
+    memcpy(slot.data, data, bytes);
+
+    // Sequentially consistent against the consumer's flag-then-recheck, so
+    // either it sees this frame or we see it waiting
+    ring->tail.store(tail + 1, std::memory_order_seq_cst);
+    if (ring->consumerWaiting.exchange(0, std::memory_order_seq_cst)) {
+        uint64_t one = 1;
+        if (write(doorbell, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            return -1;
+        }
+    }
+    return bytes;
+}
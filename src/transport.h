@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "clock.h"
+#include "shm_ring.h"
+
+// Where a sender's frames go. Transports are long-lived: open() before each
+// transmission makes sure the connection is current, and send() takes one
+// datagram, the 4-byte length header and the frame.
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    virtual bool open(Clock& clock) = 0;
+    virtual void close() = 0;
+
+    // Bytes accepted, or -1 with errno set; ECONNREFUSED when nothing is listening
+    virtual ssize_t send(const uint8_t* data, size_t bytes) = 0;
+
+    // The socket the frames leave on, for TX timestamps and packet capture;
+    // -1 when they don't go through the network stack
+    virtual int fd() const { return -1; }
+    virtual const std::string& name() const = 0;
+
+    // Frames accepted but discarded since open(), when the far end falls behind
+    virtual long dropped() const { return 0; }
+};
+
+// Applied when a destination resolves to a multicast group, so one datagram
+// per frame reaches every bridge that has joined it
+struct MulticastSettings {
+    int ttl = 1;            // Hops; 1 keeps it on the local segment
+    std::string interface;  // Outgoing interface, by name or IPv4 address (empty = routing table)
+    bool loop = true;       // Deliver to listeners on this host as well
+};
+
+// A long-lived connected UDP socket to one bridge, or to a multicast group. The host is resolved with
+// getaddrinfo (names, IPv4 and IPv6), and re-resolved when it is older than
+// resolveInterval seconds, reconnecting only if the address changed. Being
+// connected, send() skips the per-datagram route lookup and reports
+// ECONNREFUSED once an ICMP port unreachable has come back for an earlier
+// datagram, i.e. when nothing is listening.
+class UdpTransport : public Transport {
+public:
+    UdpTransport(const std::string& host, int port, int resolveInterval = 300,
+                 const MulticastSettings& multicast = MulticastSettings())
+        : host(host), port(port), resolveInterval(resolveInterval), multicast(multicast) {}
+    ~UdpTransport();
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    // Make sure the socket is connected to a current address; call before
+    // each transmission. Clears any error left over from the last one.
+    bool open(Clock& clock) override;
+    void close() override;
+
+    ssize_t send(const uint8_t* data, size_t bytes) override { return ::send(sock, data, bytes, 0); }
+
+    int fd() const override { return sock; }
+    const std::string& name() const override { return description; }  // host[address]:port
+
+private:
+    bool resolve(struct sockaddr_storage& addr, socklen_t& addrLen);
+    bool setupMulticast();
+
+    std::string host;
+    int port;
+    int resolveInterval;
+    MulticastSettings multicast;
+
+    int sock = -1;
+    struct sockaddr_storage peer;
+    socklen_t peerLen = 0;
+    time_t resolvedAt = 0;
+    std::string description;
+};
+
+// Frames for a bridge on this host, written into a shared-memory ring (see
+// shm_ring.h) instead of through the UDP stack. open() connects to the
+// consumer's unix socket at path and hands it the ring, reconnecting if the
+// consumer has gone away since the last transmission. A frame published while
+// the ring is full is dropped, as a datagram would be; if the consumer has
+// disconnected by then, send() fails with ECONNREFUSED.
+class ShmTransport : public Transport {
+public:
+    explicit ShmTransport(const std::string& path) : path(path), description("shm:" + path) {}
+    ~ShmTransport();
+
+    ShmTransport(const ShmTransport&) = delete;
+    ShmTransport& operator=(const ShmTransport&) = delete;
+
+    bool open(Clock& clock) override;
+    void close() override;
+
+    ssize_t send(const uint8_t* data, size_t bytes) override;
+
+    const std::string& name() const override { return description; }
+
+    long dropped() const override { return droppedFrames; }
+
+private:
+    bool consumerGone() const;
+
+    std::string path;
+    std::string description;
+
+    int control = -1;   // Unix socket to the consumer
+    int doorbell = -1;  // eventfd
+    ShmRing* ring = nullptr;
+    long droppedFrames = 0;
+};
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <poll.h>
+
+#include "txstamp.h"
+
+bool enableTxTimestamps(int sock, bool hardware) {
+    std::vector<TxStamp> stale;
+    disableTxTimestamps(sock);
+    readTxTimestamps(sock, stale);
+
+    // Stamps are tagged with a per-socket datagram counter and come back
+    // without a copy of the payload
+    unsigned int flags = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE |
+                         SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID |
+                         SOF_TIMESTAMPING_OPT_TSONLY;
+    if (hardware) {
+        flags |= SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+    if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+        perror("SO_TIMESTAMPING");
+        return false;
+    }
+    return true;
+}
+
+void disableTxTimestamps(int sock) {
+    unsigned int flags = 0;
+    setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+}
+
+void readTxTimestamps(int sock, std::vector<TxStamp>& out) {
+    char control[512];
+    while (true) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            return;
+        }
+
+        struct scm_timestamping stamps;
+        bool haveStamps = false;
+        struct sock_extended_err err;
+        bool haveErr = false;
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPING) {
+                memcpy(&stamps, CMSG_DATA(c), sizeof(stamps));
+                haveStamps = true;
+            } else if ((c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR) ||
+                       (c->cmsg_level == SOL_IPV6 && c->cmsg_type == IPV6_RECVERR)) {
+                memcpy(&err, CMSG_DATA(c), sizeof(err));
+                haveErr = err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING;
+            }
+        }
+        if (!haveStamps || !haveErr) {
+            continue;
+        }
+
+        // ts[0] is the software stamp, ts[2] the raw hardware one
+        TxStamp stamp;
+        stamp.index = err.ee_data;
+        if (stamps.ts[2].tv_sec || stamps.ts[2].tv_nsec) {
+            stamp.type = TX_HARDWARE;
+            stamp.ns = stamps.ts[2].tv_sec * 1000000000LL + stamps.ts[2].tv_nsec;
+        } else {
+            stamp.type = err.ee_info == SCM_TSTAMP_SCHED ? TX_SCHED : TX_SOFTWARE;
+            stamp.ns = stamps.ts[0].tv_sec * 1000000000LL + stamps.ts[0].tv_nsec;
+        }
+        out.push_back(stamp);
+    }
+}
+
+void awaitTxTimestamps(int sock, std::vector<TxStamp>& out, int timeoutMs) {
+    // The error queue signals POLLERR; no events need to be requested for it
+    struct pollfd pfd = {sock, 0, 0};
+    if (poll(&pfd, 1, timeoutMs) > 0) {
+        readTxTimestamps(sock, out);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+// Kernel transmit timestamps (SO_TIMESTAMPING) for a UDP socket. Each sent
+// datagram can be stamped when it enters the qdisc (TX_SCHED), when it is
+// handed to the driver (TX_SOFTWARE) and, on NICs with hardware timestamping
+// enabled, when it leaves the wire (TX_HARDWARE). The stamps are queued on
+// the socket's error queue and tagged with the datagram's index, counting
+// from 0 at the first send after enableTxTimestamps().
+enum TxStampType { TX_SCHED, TX_SOFTWARE, TX_HARDWARE };
+
+struct TxStamp {
+    long index;
+    TxStampType type;
+    long long ns;  // CLOCK_REALTIME (hardware: the NIC's clock)
+};
+
+// Enabling restarts the datagram counter and discards stamps left queued
+// from before; disable after a transmission on a socket that is kept open
+bool enableTxTimestamps(int sock, bool hardware);
+void disableTxTimestamps(int sock);
+
+// Append every stamp queued so far to out. Never blocks.
+void readTxTimestamps(int sock, std::vector<TxStamp>& out);
+
+// Wait up to timeoutMs for stamps to be queued, then read them
+void awaitTxTimestamps(int sock, std::vector<TxStamp>& out, int timeoutMs);
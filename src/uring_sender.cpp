@@ -0,0 +1,507 @@
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "uring_sender.h"
+
+// Minimal io_uring over the raw system calls, so liburing isn't a dependency
+class Ring {
+public:
+    ~Ring();
+
+    bool init(unsigned entries);
+
+    // Next free submission entry, cleared, or nullptr when the queue is full
+    struct io_uring_sqe* next();
+    unsigned space() const;
+
+    // Submit everything queued and wait for at least minComplete completions,
+    // or until timeoutUsec has passed (-1 waits indefinitely)
+    int enter(unsigned minComplete, long timeoutUsec = -1);
+
+    bool pop(struct io_uring_cqe& cqe);
+
+private:
+    bool probeLinkedTimeout();
+
+    int fd = -1;
+    void* sqMap = MAP_FAILED;
+    void* cqMap = MAP_FAILED;
+    size_t sqMapBytes = 0;
+    size_t cqMapBytes = 0;
+    struct io_uring_sqe* sqes = (struct io_uring_sqe*)MAP_FAILED;
+    size_t sqesBytes = 0;
+
+    unsigned sqEntries = 0;
+    unsigned sqMask = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned sqLocalTail = 0;  // Entries filled in, published by enter()
+
+    unsigned cqMask = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    struct io_uring_cqe* cqes = nullptr;
+};
+
+Ring::~Ring() {
+    if (sqes != MAP_FAILED) {
+        munmap(sqes, sqesBytes);
+    }
+    if (cqMap != MAP_FAILED && cqMap != sqMap) {
+        munmap(cqMap, cqMapBytes);
+    }
+    if (sqMap != MAP_FAILED) {
+        munmap(sqMap, sqMapBytes);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool Ring::init(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        perror("io_uring_setup");
+        return false;
+    }
+    // Skipped completions (Linux 5.17) and bounded waits (5.11)
+    if (!(params.features & IORING_FEAT_CQE_SKIP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        std::cerr << "io_uring on this kernel is too old for the linked-timeout sender" << std::endl;
+        return false;
+    }
+
+    sqMapBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqMapBytes = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+        sqMapBytes = cqMapBytes = std::max(sqMapBytes, cqMapBytes);
+    }
+    sqMap = mmap(nullptr, sqMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqMap == MAP_FAILED) {
+        perror("io_uring mmap");
+        return false;
+    }
+    cqMap = single ? sqMap
+                   : mmap(nullptr, cqMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    sqesBytes = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = (struct io_uring_sqe*)mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      fd, IORING_OFF_SQES);
+    if (cqMap == MAP_FAILED || sqes == MAP_FAILED) {
+        perror("io_uring mmap");
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(sqMap);
+    sqEntries = params.sq_entries;
+    sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    sqHead = (unsigned*)(sq + params.sq_off.head);
+    sqTail = (unsigned*)(sq + params.sq_off.tail);
+    sqLocalTail = *sqTail;
+    // Submission entries are always used in ring order
+    unsigned* array = (unsigned*)(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sqEntries; i++) {
+        array[i] = i;
+    }
+
+    uint8_t* cq = static_cast<uint8_t*>(cqMap);
+    cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    cqHead = (unsigned*)(cq + params.cq_off.head);
+    cqTail = (unsigned*)(cq + params.cq_off.tail);
+    cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    if (!probeLinkedTimeout()) {
+        std::cerr << "io_uring on this kernel can't release a send on a timeout" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Every timed frame is an expired IORING_TIMEOUT_ETIME_SUCCESS timeout,
+// completing silently, that lets the send linked behind it go ahead. Queue
+// one already due in front of a NOP: only the NOP should complete.
+bool Ring::probeLinkedTimeout() {
+    struct __kernel_timespec due = {0, 0};
+    struct io_uring_sqe* timeout = next();
+    struct io_uring_sqe* nop = next();
+    if (!timeout || !nop) {
+        return false;
+    }
+    timeout->opcode = IORING_OP_TIMEOUT;
+    timeout->fd = -1;
+    timeout->addr = reinterpret_cast<uint64_t>(&due);
+    timeout->len = 1;
+    timeout->timeout_flags = IORING_TIMEOUT_ABS | IORING_TIMEOUT_ETIME_SUCCESS;
+    timeout->flags = IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+    timeout->user_data = 1;
+    nop->opcode = IORING_OP_NOP;
+    nop->user_data = 2;
+
+    struct io_uring_cqe cqe;
+    while (!pop(cqe)) {
+        if (enter(1, 1000000) < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+    // The timeout completing instead means the flag was rejected
+    return cqe.user_data == 2 && cqe.res == 0;
+}
+
+struct io_uring_sqe* Ring::next() {
+    if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+        return nullptr;
+    }
+    struct io_uring_sqe* sqe = &sqes[sqLocalTail & sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqLocalTail++;
+    return sqe;
+}
+
+unsigned Ring::space() const {
+    return sqEntries - (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE));
+}
+
+int Ring::enter(unsigned minComplete, long timeoutUsec) {
+    __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+    unsigned pending = sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    if (timeoutUsec < 0) {
+        return syscall(__NR_io_uring_enter, fd, pending, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+    struct __kernel_timespec wait = {timeoutUsec / 1000000, (timeoutUsec % 1000000) * 1000};
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&wait);
+    return syscall(__NR_io_uring_enter, fd, pending, minComplete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                   &arg, sizeof(arg));
+}
+
+bool Ring::pop(struct io_uring_cqe& cqe) {
+    unsigned head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    cqe = cqes[head & cqMask];
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// What a completion is for: destination, frame and operation packed into user_data
+enum UringOp { OP_TIMEOUT, OP_SEND, OP_CANCEL };
+
+static uint64_t uringTag(size_t dest, long frame, UringOp op) {
+    return (static_cast<uint64_t>(dest) << 40) | (static_cast<uint64_t>(frame) << 2) | op;
+}
+
+// How long past the last frame's due time to wait for the completions still
+// outstanding before giving up on them
+constexpr long SETTLE_USEC = 1000000;
+
+// One destination's frames in flight. Frame k lives in slot k % batch from
+// being queued until its send completes.
+struct UringStream {
+    UringStream(Transmission& t, int batch)
+        : t(t), schedule(*t.samples, t.options), packets(batch), deadlines(batch),
+          frame(batch, -1), timed(batch, 0), handoffUsec(batch, 0), encoder(t.options.wire) {}
+
+    struct Packet {
+        uint8_t pcm[FRAME_SIZE];
+        uint8_t data[MAX_DATAGRAM];
+        size_t bytes;
+    };
+
+    Transmission& t;
+    FrameSchedule schedule;
+    int sock = -1;
+    bool timestamps = false;
+    std::vector<TxStamp> stamps;
+
+    std::vector<Packet> packets;
+    std::vector<struct __kernel_timespec> deadlines;
+    std::vector<long> frame;        // Frame in each slot, -1 when free
+    std::vector<char> timed;        // The slot's send waits behind a timeout
+    std::vector<long> handoffUsec;  // When the kernel was due to issue the send
+    FrameEncoder encoder;
+
+    long queued = 0;
+    long inFlight = 0;
+    long sent = 0;
+    bool failed = false;
+};
+
+// Stop queueing frames for a destination and pull back the ones still waiting
+// for their due time; sends already issued complete regardless
+static void abortStream(Ring& ring, UringStream& s, size_t index) {
+    s.failed = true;
+    for (size_t slot = 0; slot < s.frame.size(); slot++) {
+        if (s.frame[slot] < 0 || !s.timed[slot]) {
+            continue;
+        }
+        struct io_uring_sqe* sqe = ring.next();
+        if (!sqe) {
+            break;
+        }
+        sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = uringTag(index, s.frame[slot], OP_TIMEOUT);
+        sqe->user_data = uringTag(index, 0, OP_CANCEL);
+    }
+}
+
+bool sendAudioUring(std::vector<Transmission>& transmissions, int batch) {
+    batch = std::max(1, batch);
+    Clock& clock = systemClock();
+    for (const auto& t : transmissions) {
+        // Due times are absolute CLOCK_MONOTONIC deadlines handed to the kernel
+        if (t.options.clock != &clock) {
+            std::cerr << "The io_uring sender only paces on the system clock" << std::endl;
+            return false;
+        }
+        if (!dynamic_cast<UdpTransport*>(t.transport)) {
+            std::cerr << "The io_uring sender only sends over UDP, not to " << t.transport->name() << std::endl;
+            return false;
+        }
+    }
+
+    // A timeout and a send per queued frame, plus room for cancellations
+    std::vector<UringStream> streams;
+    streams.reserve(transmissions.size());
+    Ring ring;
+    unsigned entries = std::min<size_t>(32768, transmissions.size() * (batch * 2 + batch));
+    if (!ring.init(std::max(1u, entries))) {
+        return false;
+    }
+
+    for (auto& t : transmissions) {
+        t.ok = false;
+        if (!t.transport->open(clock)) {
+            continue;
+        }
+        streams.emplace_back(t, batch);
+        UringStream& s = streams.back();
+        s.sock = t.transport->fd();
+        s.stamps.reserve(64);
+        std::cout << "Sending " << t.samples->size() * sizeof(int16_t) << " bytes ("
+                  << t.samples->size() * sizeof(int16_t) / FRAME_SIZE << " frames) to "
+                  << t.transport->name() << wireDescription(t.options.wire) << std::endl;
+
+        s.timestamps = (t.options.pcap || t.options.stats) && enableTxTimestamps(s.sock, t.options.hardwareTimestamps);
+        if (t.options.pcap) {
+            t.options.pcap->attach(s.sock, clock);
+        }
+    }
+
+    long startUsec = clock.monotonicUsec();
+    long lastDueUsec = startUsec;
+    bool rejected = false;
+    for (auto& s : streams) {
+        if (s.t.options.stats) {
+            s.t.options.stats->begin(s.schedule.frames, startUsec);
+        }
+    }
+
+    while (true) {
+        // Keep each destination's next frames queued, in order
+        long busy = 0;
+        for (size_t i = 0; i < streams.size(); i++) {
+            UringStream& s = streams[i];
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(s.t.samples->data());
+            size_t totalBytes = s.t.samples->size() * sizeof(int16_t);
+            while (!s.failed && s.queued < s.schedule.frames) {
+                long k = s.queued;
+                size_t slot = k % batch;
+                if (s.frame[slot] >= 0) {
+                    break;
+                }
+                long dueUsec = startUsec + s.schedule.dueUsec(k);
+                long nowUsec = clock.monotonicUsec();
+                bool timed = dueUsec > nowUsec;
+
+                // Frames already due (the pre-roll burst, or after falling
+                // behind) go straight out without a timeout. Both entries are
+                // reserved first, so a timeout is never left without its send.
+                if (ring.space() < (timed ? 2u : 1u)) {
+                    break;
+                }
+                struct io_uring_sqe* timeout = timed ? ring.next() : nullptr;
+                struct io_uring_sqe* send = ring.next();
+
+                UringStream::Packet& packet = s.packets[slot];
+                size_t offset = k * FRAME_SIZE;
+                size_t chunkSize = std::min((size_t)FRAME_SIZE, totalBytes - offset);
+                memcpy(packet.pcm, data + offset, chunkSize);
+                memset(packet.pcm + chunkSize, 0, FRAME_SIZE - chunkSize);
+                packet.bytes = s.encoder.encode(packet.pcm, packet.data);
+                if (timed) {
+                    s.deadlines[slot].tv_sec = dueUsec / 1000000;
+                    s.deadlines[slot].tv_nsec = (dueUsec % 1000000) * 1000;
+                    timeout->opcode = IORING_OP_TIMEOUT;
+                    timeout->fd = -1;
+                    timeout->addr = reinterpret_cast<uint64_t>(&s.deadlines[slot]);
+                    timeout->len = 1;
+                    timeout->timeout_flags = IORING_TIMEOUT_ABS | IORING_TIMEOUT_ETIME_SUCCESS;
+                    timeout->flags = IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+                    timeout->user_data = uringTag(i, k, OP_TIMEOUT);
+                }
+                send->opcode = IORING_OP_SEND;
+                send->fd = s.sock;
+                send->addr = reinterpret_cast<uint64_t>(packet.data);
+                send->len = packet.bytes;
+                send->user_data = uringTag(i, k, OP_SEND);
+
+                s.frame[slot] = k;
+                s.timed[slot] = timed;
+                s.handoffUsec[slot] = std::max(dueUsec, nowUsec);
+                lastDueUsec = std::max(lastDueUsec, s.handoffUsec[slot]);
+                s.queued++;
+                s.inFlight++;
+            }
+            busy += s.inFlight;
+        }
+        if (busy == 0) {
+            break;
+        }
+
+        // Every queued frame is due by lastDueUsec; anything still outstanding
+        // well after that isn't coming back
+        long waitUsec = lastDueUsec + SETTLE_USEC - clock.monotonicUsec();
+        if (waitUsec <= 0) {
+            for (auto& s : streams) {
+                if (s.inFlight > 0) {
+                    std::cerr << "io_uring: " << s.inFlight << " frames to " << s.t.transport->name()
+                              << " never completed" << std::endl;
+                    s.failed = true;
+                }
+            }
+            break;
+        }
+        if (ring.enter(1, waitUsec) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY && errno != ETIME) {
+            perror("io_uring_enter");
+            for (size_t i = 0; i < streams.size(); i++) {
+                streams[i].failed = true;
+            }
+            break;
+        }
+
+        struct io_uring_cqe cqe;
+        while (ring.pop(cqe)) {
+            size_t i = cqe.user_data >> 40;
+            long k = static_cast<long>((cqe.user_data >> 2) & ((1ULL << 38) - 1));
+            UringOp op = static_cast<UringOp>(cqe.user_data & 3);
+            UringStream& s = streams[i];
+            if (op == OP_CANCEL) {
+                continue;
+            }
+            size_t slot = k % batch;
+            if (op == OP_TIMEOUT) {
+                if (cqe.res == -ETIME) {
+                    continue;
+                }
+                // Only posted when the link broke: cancelled by an abort, or
+                // rejected. The send behind it then completes without a CQE
+                // of its own, so the slot is settled here.
+                if (s.frame[slot] == k) {
+                    s.frame[slot] = -1;
+                    s.inFlight--;
+                }
+                if (cqe.res != -ECANCELED && !s.failed) {
+                    std::cerr << "io_uring timeout for " << s.t.transport->name() << ": "
+                              << strerror(-cqe.res) << std::endl;
+                    // Before anything has gone out, the caller can still fall
+                    // back to the threaded sender for every destination
+                    long sentTotal = 0;
+                    for (const auto& other : streams) {
+                        sentTotal += other.sent;
+                    }
+                    if (sentTotal == 0) {
+                        rejected = true;
+                        for (size_t j = 0; j < streams.size(); j++) {
+                            if (!streams[j].failed) {
+                                abortStream(ring, streams[j], j);
+                            }
+                        }
+                    } else {
+                        abortStream(ring, s, i);
+                    }
+                }
+                continue;
+            }
+
+            // Already settled by its timeout's completion
+            if (s.frame[slot] != k) {
+                continue;
+            }
+            s.inFlight--;
+            if (cqe.res < 0) {
+                if (!s.failed) {
+                    // ICMP port unreachable for an earlier frame: no bridge is listening
+                    if (cqe.res == -ECONNREFUSED) {
+                        std::cerr << "Nothing listening at " << s.t.transport->name() << ", aborting after "
+                                  << s.sent << " frames" << std::endl;
+                    } else {
+                        std::cerr << "send to " << s.t.transport->name() << ": " << strerror(-cqe.res) << std::endl;
+                    }
+                    abortStream(ring, s, i);
+                }
+                s.frame[slot] = -1;
+                continue;
+            }
+
+            // The send was issued by the kernel at the due time (or as soon as
+            // it was queued, if later); this is when we learned it had completed
+            long doneUsec = clock.monotonicUsec();
+            const SendOptions& options = s.t.options;
+            const UringStream::Packet& packet = s.packets[slot];
+            if (options.capture) {
+                options.capture->push(packet.pcm, FRAME_SIZE, doneUsec);
+            }
+            if (options.pcap) {
+                options.pcap->push(packet.data, packet.bytes, k, doneUsec);
+            }
+            if (options.stats) {
+                options.stats->sent(k, s.schedule.dueUsec(k), s.handoffUsec[slot], doneUsec);
+            }
+            if (s.timestamps) {
+                readTxTimestamps(s.sock, s.stamps);
+                deliverTxStamps(s.stamps, options);
+            }
+            s.frame[slot] = -1;
+            s.sent++;
+        }
+    }
+
+    for (auto& s : streams) {
+        // Stamps for the last frames may still be on their way
+        if (s.timestamps) {
+            awaitTxTimestamps(s.sock, s.stamps, 50);
+            deliverTxStamps(s.stamps, s.t.options);
+            disableTxTimestamps(s.sock);
+        }
+        s.t.ok = !s.failed && s.sent == s.schedule.frames;
+        if (!s.t.ok) {
+            continue;
+        }
+        std::cout << "Done sending audio to " << s.t.transport->name() << std::endl;
+        if (s.schedule.preroll > 0) {
+            std::cout << "Pre-roll: " << s.schedule.preroll + 1 << " frames in the opening burst, audio reached "
+                      << s.t.transport->name() << " " << s.schedule.preroll * 20 << " ms sooner" << std::endl;
+        }
+    }
+
+    long sentTotal = 0;
+    for (const auto& s : streams) {
+        sentTotal += s.sent;
+    }
+    if (rejected && sentTotal == 0) {
+        std::cerr << "io_uring rejected the frame timeouts before anything was sent" << std::endl;
+        return false;
+    }
+    return true;
+}
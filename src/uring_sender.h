@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sender.h"
+
+// io_uring alternative to running sendAudioToDVMBridge() on a thread per
+// destination: the calling thread paces every destination at once. Each frame
+// is queued as a send linked behind a timeout on the frame's absolute due
+// time, so the kernel releases it on schedule without waking us; up to batch
+// frames per destination are queued ahead, and one io_uring_enter() both
+// submits new frames and collects the completions of all the destinations.
+// Send errors come back in completions; ECONNREFUSED aborts that destination
+// only, cancelling its queued frames.
+//
+// Needs the system clock and UDP transports. Returns false, having sent
+// nothing, when io_uring is unavailable (old kernel, or disabled by sysctl or
+// seccomp) or a destination isn't UDP, so the caller can fall back to the
+// threaded sender.
+bool sendAudioUring(std::vector<Transmission>& transmissions, int batch);